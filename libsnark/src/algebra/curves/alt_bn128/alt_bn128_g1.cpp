@@ -6,6 +6,7 @@
  *****************************************************************************/
 
 #include "algebra/curves/alt_bn128/alt_bn128_g1.hpp"
+#include "algebra/scalar_multiplication/wnaf.hpp"
 
 namespace libsnark {
 
@@ -357,6 +358,12 @@ alt_bn128_G1 alt_bn128_G1::dbl() const
     return alt_bn128_G1(X3, Y3, Z3);
 }
 
+alt_bn128_G1 alt_bn128_G1::mul_by_lambda() const
+{
+    // (x, y) -> (beta * x, y) maps to (beta * X, Y, Z) in Jacobian coordinates
+    return alt_bn128_G1(alt_bn128_G1_glv_beta * this->X, this->Y, this->Z);
+}
+
 bool alt_bn128_G1::is_well_formed() const
 {
     if (this->is_zero())
@@ -398,7 +405,12 @@ alt_bn128_G1 alt_bn128_G1::one()
 
 alt_bn128_G1 alt_bn128_G1::random_element()
 {
-    return (scalar_field::random_element().as_bigint()) * G1_one;
+    return scalar_field::random_element() * G1_one;
+}
+
+alt_bn128_G1 operator*(const alt_bn128_Fr &lhs, const alt_bn128_G1 &rhs)
+{
+    return opt_window_glv_wnaf_exp(rhs, lhs.as_bigint(), alt_bn128_Fr::num_bits);
 }
 
 std::ostream& operator<<(std::ostream &out, const alt_bn128_G1 &g)
@@ -499,19 +511,33 @@ std::istream& operator>>(std::istream& in, std::vector<alt_bn128_G1> &v)
 template<>
 void batch_to_special_all_non_zeros<alt_bn128_G1>(std::vector<alt_bn128_G1> &vec)
 {
-    std::vector<alt_bn128_Fq> Z_vec;
-    Z_vec.reserve(vec.size());
+    /* zeros are also accepted, and put in the special form of zero */
+    std::vector<alt_bn128_Fq> Z_vec(vec.size());
 
-    for (auto &el: vec)
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < vec.size(); ++i)
     {
-        Z_vec.emplace_back(el.Z);
+        Z_vec[i] = vec[i].Z;
     }
     batch_invert<alt_bn128_Fq>(Z_vec);
 
+    const alt_bn128_Fq zero = alt_bn128_Fq::zero();
     const alt_bn128_Fq one = alt_bn128_Fq::one();
 
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
     for (size_t i = 0; i < vec.size(); ++i)
     {
+        if (Z_vec[i].is_zero())
+        {
+            vec[i].X = zero;
+            vec[i].Y = one;
+            continue;
+        }
+
         alt_bn128_Fq Z2 = Z_vec[i].squared();
         alt_bn128_Fq Z3 = Z_vec[i] * Z2;
 
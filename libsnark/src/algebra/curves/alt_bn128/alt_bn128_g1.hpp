@@ -56,6 +56,7 @@ public:
     alt_bn128_G1 add(const alt_bn128_G1 &other) const;
     alt_bn128_G1 mixed_add(const alt_bn128_G1 &other) const;
     alt_bn128_G1 dbl() const;
+    alt_bn128_G1 mul_by_lambda() const;
 
     bool is_well_formed() const;
 
@@ -83,6 +84,33 @@ alt_bn128_G1 operator*(const Fp_model<m,modulus_p> &lhs, const alt_bn128_G1 &rhs
     return scalar_mul<alt_bn128_G1, m>(rhs, lhs.as_bigint());
 }
 
+alt_bn128_G1 operator*(const alt_bn128_Fr &lhs, const alt_bn128_G1 &rhs);
+
+template<>
+class glv_endomorphism<alt_bn128_G1> {
+public:
+    static const bool available = true;
+
+    static alt_bn128_G1 apply(const alt_bn128_G1 &P)
+    {
+        return P.mul_by_lambda();
+    }
+
+    static void decompose(const bigint<alt_bn128_r_limbs> &k,
+                          bigint<alt_bn128_r_limbs> &k1, bool &k1_neg,
+                          bigint<alt_bn128_r_limbs> &k2, bool &k2_neg)
+    {
+        alt_bn128_glv_decompose(k, k1, k1_neg, k2, k2_neg);
+    }
+};
+
+template<>
+class batch_affine_addition<alt_bn128_G1> {
+public:
+    static const bool available = true;
+    typedef alt_bn128_Fq coordinate_field;
+};
+
 std::ostream& operator<<(std::ostream& out, const std::vector<alt_bn128_G1> &v);
 std::istream& operator>>(std::istream& in, std::vector<alt_bn128_G1> &v);
 
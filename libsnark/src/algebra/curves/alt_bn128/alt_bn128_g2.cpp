@@ -6,6 +6,7 @@
  *****************************************************************************/
 
 #include "algebra/curves/alt_bn128/alt_bn128_g2.hpp"
+#include "algebra/scalar_multiplication/wnaf.hpp"
 
 namespace libsnark {
 
@@ -371,6 +372,12 @@ alt_bn128_G2 alt_bn128_G2::mul_by_q() const
                       (this->Z).Frobenius_map(1));
 }
 
+alt_bn128_G2 alt_bn128_G2::mul_by_lambda() const
+{
+    // (x, y) -> (beta * x, y) maps to (beta * X, Y, Z) in Jacobian coordinates
+    return alt_bn128_G2(alt_bn128_G2_glv_beta * this->X, this->Y, this->Z);
+}
+
 bool alt_bn128_G2::is_well_formed() const
 {
     if (this->is_zero())
@@ -412,7 +419,12 @@ alt_bn128_G2 alt_bn128_G2::one()
 
 alt_bn128_G2 alt_bn128_G2::random_element()
 {
-    return (alt_bn128_Fr::random_element().as_bigint()) * G2_one;
+    return alt_bn128_Fr::random_element() * G2_one;
+}
+
+alt_bn128_G2 operator*(const alt_bn128_Fr &lhs, const alt_bn128_G2 &rhs)
+{
+    return opt_window_glv_wnaf_exp(rhs, lhs.as_bigint(), alt_bn128_Fr::num_bits);
 }
 
 std::ostream& operator<<(std::ostream &out, const alt_bn128_G2 &g)
@@ -480,19 +492,33 @@ std::istream& operator>>(std::istream &in, alt_bn128_G2 &g)
 template<>
 void batch_to_special_all_non_zeros<alt_bn128_G2>(std::vector<alt_bn128_G2> &vec)
 {
-    std::vector<alt_bn128_Fq2> Z_vec;
-    Z_vec.reserve(vec.size());
+    /* zeros are also accepted, and put in the special form of zero */
+    std::vector<alt_bn128_Fq2> Z_vec(vec.size());
 
-    for (auto &el: vec)
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < vec.size(); ++i)
     {
-        Z_vec.emplace_back(el.Z);
+        Z_vec[i] = vec[i].Z;
     }
     batch_invert<alt_bn128_Fq2>(Z_vec);
 
+    const alt_bn128_Fq2 zero = alt_bn128_Fq2::zero();
     const alt_bn128_Fq2 one = alt_bn128_Fq2::one();
 
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
     for (size_t i = 0; i < vec.size(); ++i)
     {
+        if (Z_vec[i].is_zero())
+        {
+            vec[i].X = zero;
+            vec[i].Y = one;
+            continue;
+        }
+
         alt_bn128_Fq2 Z2 = Z_vec[i].squared();
         alt_bn128_Fq2 Z3 = Z_vec[i] * Z2;
 
@@ -60,6 +60,7 @@ public:
     alt_bn128_G2 mixed_add(const alt_bn128_G2 &other) const;
     alt_bn128_G2 dbl() const;
     alt_bn128_G2 mul_by_q() const;
+    alt_bn128_G2 mul_by_lambda() const;
 
     bool is_well_formed() const;
 
@@ -87,6 +88,33 @@ alt_bn128_G2 operator*(const Fp_model<m,modulus_p> &lhs, const alt_bn128_G2 &rhs
     return scalar_mul<alt_bn128_G2, m>(rhs, lhs.as_bigint());
 }
 
+alt_bn128_G2 operator*(const alt_bn128_Fr &lhs, const alt_bn128_G2 &rhs);
+
+template<>
+class glv_endomorphism<alt_bn128_G2> {
+public:
+    static const bool available = true;
+
+    static alt_bn128_G2 apply(const alt_bn128_G2 &P)
+    {
+        return P.mul_by_lambda();
+    }
+
+    static void decompose(const bigint<alt_bn128_r_limbs> &k,
+                          bigint<alt_bn128_r_limbs> &k1, bool &k1_neg,
+                          bigint<alt_bn128_r_limbs> &k2, bool &k2_neg)
+    {
+        alt_bn128_glv_decompose(k, k1, k1_neg, k2, k2_neg);
+    }
+};
+
+template<>
+class batch_affine_addition<alt_bn128_G2> {
+public:
+    static const bool available = true;
+    typedef alt_bn128_Fq2 coordinate_field;
+};
+
 template<typename T>
 void batch_to_special_all_non_zeros(std::vector<T> &vec);
 template<>
@@ -28,6 +28,16 @@ bigint<12*alt_bn128_q_limbs> alt_bn128_final_exponent;
 bigint<alt_bn128_q_limbs> alt_bn128_final_exponent_z;
 bool alt_bn128_final_exponent_is_z_neg;
 
+alt_bn128_Fq alt_bn128_G1_glv_beta;
+alt_bn128_Fq alt_bn128_G2_glv_beta;
+bigint<alt_bn128_r_limbs> alt_bn128_glv_lambda;
+bigint<alt_bn128_r_limbs> alt_bn128_glv_a1;
+bigint<alt_bn128_r_limbs> alt_bn128_glv_minus_b1;
+bigint<alt_bn128_r_limbs> alt_bn128_glv_a2;
+bigint<alt_bn128_r_limbs> alt_bn128_glv_b2;
+bigint<alt_bn128_r_limbs> alt_bn128_glv_g1;
+bigint<alt_bn128_r_limbs> alt_bn128_glv_g2;
+
 void init_alt_bn128_params()
 {
     typedef bigint<alt_bn128_r_limbs> bigint_r;
@@ -93,6 +103,7 @@ void init_alt_bn128_params()
     alt_bn128_Fq2::t = bigint<2*alt_bn128_q_limbs>("29943448501038927652624252826042421299953269783193801402277987640879380855398639840490065738714866998199264519675818766364765977133724184290399563929243");
     alt_bn128_Fq2::t_minus_1_over_2 = bigint<2*alt_bn128_q_limbs>("14971724250519463826312126413021210649976634891596900701138993820439690427699319920245032869357433499099632259837909383182382988566862092145199781964621");
     alt_bn128_Fq2::non_residue = alt_bn128_Fq("21888242871839275222246405745257275088696311157297823662689037894645226208582");
+    alt_bn128_Fq2::non_residue_is_minus_one = true;
     alt_bn128_Fq2::nqr = alt_bn128_Fq2(alt_bn128_Fq("2"),alt_bn128_Fq("1"));
     alt_bn128_Fq2::nqr_to_t = alt_bn128_Fq2(alt_bn128_Fq("5033503716262624267312492558379982687175200734934877598599011485707452665730"),alt_bn128_Fq("314498342015008975724433667930697407966947188435857772134235984660852259084"));
     alt_bn128_Fq2::Frobenius_coeffs_c1[0] = alt_bn128_Fq("1");
@@ -100,6 +111,7 @@ void init_alt_bn128_params()
 
     /* parameters for Fq6 */
     alt_bn128_Fq6::non_residue = alt_bn128_Fq2(alt_bn128_Fq("9"),alt_bn128_Fq("1"));
+    alt_bn128_Fq6::non_residue_small_c0 = 9;
     alt_bn128_Fq6::Frobenius_coeffs_c1[0] = alt_bn128_Fq2(alt_bn128_Fq("1"),alt_bn128_Fq("0"));
     alt_bn128_Fq6::Frobenius_coeffs_c1[1] = alt_bn128_Fq2(alt_bn128_Fq("21575463638280843010398324269430826099269044274347216827212613867836435027261"),alt_bn128_Fq("10307601595873709700152284273816112264069230130616436755625194854815875713954"));
     alt_bn128_Fq6::Frobenius_coeffs_c1[2] = alt_bn128_Fq2(alt_bn128_Fq("21888242871839275220042445260109153167277707414472061641714758635765020556616"),alt_bn128_Fq("0"));
@@ -269,5 +281,74 @@ void init_alt_bn128_params()
     alt_bn128_final_exponent_z = bigint_q("4965661367192848881");
     alt_bn128_final_exponent_is_z_neg = false;
 
+    /* GLV endomorphism parameters */
+
+    alt_bn128_G1_glv_beta = alt_bn128_Fq("2203960485148121921418603742825762020974279258880205651966");
+    alt_bn128_G2_glv_beta = alt_bn128_Fq("21888242871839275220042445260109153167277707414472061641714758635765020556616");
+    alt_bn128_glv_lambda = bigint_r("4407920970296243842393367215006156084916469457145843978461");
+    alt_bn128_glv_a1 = bigint_r("9931322734385697763");
+    alt_bn128_glv_minus_b1 = bigint_r("147946756881789319000765030803803410728");
+    alt_bn128_glv_a2 = bigint_r("147946756881789319010696353538189108491");
+    alt_bn128_glv_b2 = bigint_r("9931322734385697763");
+    alt_bn128_glv_g1 = bigint_r("52538187511802934231");
+    alt_bn128_glv_g2 = bigint_r("782660544089080853078787955015628534157");
+}
+
+/*
+  Set res = |x - y| and neg = (x < y), where x and y have 2*alt_bn128_r_limbs
+  limbs and the difference is known to fit in alt_bn128_r_limbs limbs.
+*/
+static void alt_bn128_glv_signed_difference(const mp_limb_t *x, const mp_limb_t *y,
+                                            bigint<alt_bn128_r_limbs> &res, bool &neg)
+{
+    const mp_size_t n = alt_bn128_r_limbs;
+    mp_limb_t diff[2*n];
+
+    neg = (mpn_cmp(x, y, 2*n) < 0);
+    if (neg)
+    {
+        mpn_sub_n(diff, y, x, 2*n);
+    }
+    else
+    {
+        mpn_sub_n(diff, x, y, 2*n);
+    }
+
+    for (mp_size_t i = n; i < 2*n; ++i)
+    {
+        assert(diff[i] == 0);
+    }
+    mpn_copyi(res.data, diff, n);
+}
+
+/*
+  Babai rounding: with c1 ~ b2 * k / r and c2 ~ -b1 * k / r (computed with
+  the precomputed g1 and g2), the vector (k, 0) - c1 * (a1, b1) - c2 * (a2, b2)
+  is short, and congruent to (k, 0) modulo the lattice.
+*/
+void alt_bn128_glv_decompose(const bigint<alt_bn128_r_limbs> &k,
+                             bigint<alt_bn128_r_limbs> &k1, bool &k1_neg,
+                             bigint<alt_bn128_r_limbs> &k2, bool &k2_neg)
+{
+    const mp_size_t n = alt_bn128_r_limbs;
+    mp_limb_t c1[2*n], c2[2*n], t1[2*n], t2[2*n], k_ext[2*n];
+
+    mpn_mul_n(t1, k.data, alt_bn128_glv_g1.data, n);
+    mpn_mul_n(t2, k.data, alt_bn128_glv_g2.data, n);
+    mpn_copyi(c1, t1 + n, n);
+    mpn_copyi(c2, t2 + n, n);
+
+    // k1 = k - (c1 * a1 + c2 * a2)
+    mpn_mul_n(t1, c1, alt_bn128_glv_a1.data, n);
+    mpn_mul_n(t2, c2, alt_bn128_glv_a2.data, n);
+    mpn_add_n(t1, t1, t2, 2*n);
+    mpn_copyi(k_ext, k.data, n);
+    mpn_zero(k_ext + n, n);
+    alt_bn128_glv_signed_difference(k_ext, t1, k1, k1_neg);
+
+    // k2 = c1 * (-b1) - c2 * b2
+    mpn_mul_n(t1, c1, alt_bn128_glv_minus_b1.data, n);
+    mpn_mul_n(t2, c2, alt_bn128_glv_b2.data, n);
+    alt_bn128_glv_signed_difference(t1, t2, k2, k2_neg);
 }
 } // libsnark
@@ -48,8 +48,29 @@ extern bigint<12*alt_bn128_q_limbs> alt_bn128_final_exponent;
 extern bigint<alt_bn128_q_limbs> alt_bn128_final_exponent_z;
 extern bool alt_bn128_final_exponent_is_z_neg;
 
+// parameters for the GLV endomorphism (x, y) -> (beta * x, y), which acts on G1 and G2 as multiplication by lambda
+extern alt_bn128_Fq alt_bn128_G1_glv_beta;
+extern alt_bn128_Fq alt_bn128_G2_glv_beta;
+extern bigint<alt_bn128_r_limbs> alt_bn128_glv_lambda;
+// short basis (a1, b1), (a2, b2) of the lattice of (x, y) with x + y * lambda = 0 mod r; note that b1 is negative
+extern bigint<alt_bn128_r_limbs> alt_bn128_glv_a1;
+extern bigint<alt_bn128_r_limbs> alt_bn128_glv_minus_b1;
+extern bigint<alt_bn128_r_limbs> alt_bn128_glv_a2;
+extern bigint<alt_bn128_r_limbs> alt_bn128_glv_b2;
+// floor(b2 * 2^(r_limbs * GMP_NUMB_BITS) / r) and floor(-b1 * 2^(r_limbs * GMP_NUMB_BITS) / r)
+extern bigint<alt_bn128_r_limbs> alt_bn128_glv_g1;
+extern bigint<alt_bn128_r_limbs> alt_bn128_glv_g2;
+
 void init_alt_bn128_params();
 
+/**
+ * Write the scalar k as k = k1 + k2 * lambda (mod r), where k1 and k2 are
+ * given by their absolute values and signs, and have at most 128 bits each.
+ */
+void alt_bn128_glv_decompose(const bigint<alt_bn128_r_limbs> &k,
+                             bigint<alt_bn128_r_limbs> &k1, bool &k1_neg,
+                             bigint<alt_bn128_r_limbs> &k2, bool &k2_neg);
+
 class alt_bn128_G1;
 class alt_bn128_G2;
 
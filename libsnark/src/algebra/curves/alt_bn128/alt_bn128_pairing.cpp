@@ -488,6 +488,74 @@ alt_bn128_Fq12 alt_bn128_ate_double_miller_loop(const alt_bn128_ate_G1_precomp &
     return f;
 }
 
+alt_bn128_Fq12 alt_bn128_ate_multi_miller_loop(const std::vector<alt_bn128_ate_G1_precomp> &prec_P,
+                                               const std::vector<const alt_bn128_ate_G2_precomp*> &prec_Q)
+{
+    enter_block("Call to alt_bn128_ate_multi_miller_loop");
+
+    assert(prec_P.size() == prec_Q.size());
+    const size_t n = prec_P.size();
+
+    alt_bn128_Fq12 f = alt_bn128_Fq12::one();
+
+    bool found_one = false;
+    size_t idx = 0;
+
+    const bigint<alt_bn128_Fr::num_limbs> &loop_count = alt_bn128_ate_loop_count;
+    for (long i = loop_count.max_bits(); i >= 0; --i)
+    {
+        const bool bit = loop_count.test_bit(i);
+        if (!found_one)
+        {
+            /* this skips the MSB itself */
+            found_one |= bit;
+            continue;
+        }
+
+        /* code below gets executed for all bits (EXCEPT the MSB itself) of
+           alt_bn128_param_p (skipping leading zeros) in MSB to LSB
+           order; the squaring is shared by all n pairs */
+
+        f = f.squared();
+
+        for (size_t j = 0; j < n; ++j)
+        {
+            const alt_bn128_ate_ell_coeffs &c = prec_Q[j]->coeffs[idx];
+            f = f.mul_by_024(c.ell_0, prec_P[j].PY * c.ell_VW, prec_P[j].PX * c.ell_VV);
+        }
+        ++idx;
+
+        if (bit)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                const alt_bn128_ate_ell_coeffs &c = prec_Q[j]->coeffs[idx];
+                f = f.mul_by_024(c.ell_0, prec_P[j].PY * c.ell_VW, prec_P[j].PX * c.ell_VV);
+            }
+            ++idx;
+        }
+    }
+
+    if (alt_bn128_ate_is_loop_count_neg)
+    {
+    	f = f.inverse();
+    }
+
+    for (size_t k = 0; k < 2; ++k)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            const alt_bn128_ate_ell_coeffs &c = prec_Q[j]->coeffs[idx];
+            f = f.mul_by_024(c.ell_0, prec_P[j].PY * c.ell_VW, prec_P[j].PX * c.ell_VV);
+        }
+        ++idx;
+    }
+
+    leave_block("Call to alt_bn128_ate_multi_miller_loop");
+
+    return f;
+}
+
 alt_bn128_Fq12 alt_bn128_ate_pairing(const alt_bn128_G1& P, const alt_bn128_G2 &Q)
 {
     enter_block("Call to alt_bn128_ate_pairing");
@@ -533,6 +601,12 @@ alt_bn128_Fq12 alt_bn128_double_miller_loop(const alt_bn128_G1_precomp &prec_P1,
     return alt_bn128_ate_double_miller_loop(prec_P1, prec_Q1, prec_P2, prec_Q2);
 }
 
+alt_bn128_Fq12 alt_bn128_multi_miller_loop(const std::vector<alt_bn128_G1_precomp> &prec_P,
+                                           const std::vector<const alt_bn128_G2_precomp*> &prec_Q)
+{
+    return alt_bn128_ate_multi_miller_loop(prec_P, prec_Q);
+}
+
 alt_bn128_Fq12 alt_bn128_pairing(const alt_bn128_G1& P,
                       const alt_bn128_G2 &Q)
 {
@@ -43,6 +43,12 @@ alt_bn128_Fq12 alt_bn128_pp::double_miller_loop(const alt_bn128_G1_precomp &prec
     return alt_bn128_double_miller_loop(prec_P1, prec_Q1, prec_P2, prec_Q2);
 }
 
+alt_bn128_Fq12 alt_bn128_pp::multi_miller_loop(const std::vector<alt_bn128_G1_precomp> &prec_P,
+                                               const std::vector<const alt_bn128_G2_precomp*> &prec_Q)
+{
+    return alt_bn128_multi_miller_loop(prec_P, prec_Q);
+}
+
 alt_bn128_Fq12 alt_bn128_pp::pairing(const alt_bn128_G1 &P,
                                      const alt_bn128_G2 &Q)
 {
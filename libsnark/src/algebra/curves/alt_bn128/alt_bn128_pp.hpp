@@ -39,6 +39,8 @@ public:
                                              const alt_bn128_G2_precomp &prec_Q1,
                                              const alt_bn128_G1_precomp &prec_P2,
                                              const alt_bn128_G2_precomp &prec_Q2);
+    static alt_bn128_Fq12 multi_miller_loop(const std::vector<alt_bn128_G1_precomp> &prec_P,
+                                            const std::vector<const alt_bn128_G2_precomp*> &prec_Q);
     static alt_bn128_Fq12 pairing(const alt_bn128_G1 &P,
                                   const alt_bn128_G2 &Q);
     static alt_bn128_Fq12 reduced_pairing(const alt_bn128_G1 &P,
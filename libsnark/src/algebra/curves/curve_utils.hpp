@@ -16,6 +16,38 @@ namespace libsnark {
 template<typename GroupT, mp_size_t m>
 GroupT scalar_mul(const GroupT &base, const bigint<m> &scalar);
 
+/**
+ * Groups that have an efficiently computable endomorphism phi, acting as
+ * multiplication by some scalar lambda, can specialize this class to enable
+ * the GLV method of
+ * [Gallant, Lambert, and Vanstone, "Faster point multiplication on elliptic curves with efficient endomorphisms", CRYPTO '01].
+ *
+ * A specialization sets available = true and provides:
+ * - static GroupT apply(const GroupT &P), which returns phi(P) = lambda * P; and
+ * - static void decompose(const bigint<n> &k, bigint<n> &k1, bool &k1_neg, bigint<n> &k2, bool &k2_neg),
+ *   which writes the scalar k as k = k1 + k2 * lambda (modulo the group order),
+ *   where k1 and k2 (given by absolute value and sign) are about half as long as k.
+ */
+template<typename GroupT>
+class glv_endomorphism {
+public:
+    static const bool available = false;
+};
+
+/**
+ * Groups of points of short Weierstrass curves in Jacobian coordinates, whose
+ * special form (see batch_to_special) is (X, Y, 1), can specialize this class
+ * to let multi-exponentiation add points in affine coordinates, computing a
+ * whole batch of slopes with a single inversion in the field of X and Y.
+ *
+ * A specialization sets available = true and typedefs that field as coordinate_field.
+ */
+template<typename GroupT>
+class batch_affine_addition {
+public:
+    static const bool available = false;
+};
+
 } // libsnark
 #include "algebra/curves/curve_utils.tcc"
 
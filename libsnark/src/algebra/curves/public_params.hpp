@@ -59,6 +59,8 @@ namespace libsnark {
                                  const G2_precomp<EC_ppT> &prec_Q1,
                                  const G1_precomp<EC_ppT> &prec_P2,
                                  const G2_precomp<EC_ppT> &prec_Q2);
+  Fqk<EC_ppT> multi_miller_loop(const std::vector<G1_precomp<EC_ppT> > &prec_P,
+                                const std::vector<const G2_precomp<EC_ppT>*> &prec_Q);
 
   Fqk<EC_ppT> pairing(const G1<EC_ppT> &P,
                       const G2<EC_ppT> &Q);
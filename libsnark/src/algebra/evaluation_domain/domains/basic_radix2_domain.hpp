@@ -30,6 +30,8 @@ public:
     void iFFT(std::vector<FieldT> &a);
     void cosetFFT(std::vector<FieldT> &a, const FieldT &g);
     void icosetFFT(std::vector<FieldT> &a, const FieldT &g);
+    void unscaled_iFFT(const std::vector<std::vector<FieldT>*> &a);
+    void cosetFFT(const std::vector<std::vector<FieldT>*> &a, const FieldT &g, const FieldT &c);
     std::vector<FieldT> lagrange_coeffs(const FieldT &t);
     FieldT get_element(const size_t idx);
     FieldT compute_Z(const FieldT &t);
@@ -56,8 +56,8 @@ template<typename FieldT>
 void basic_radix2_domain<FieldT>::cosetFFT(std::vector<FieldT> &a, const FieldT &g)
 {
     enter_block("Execute coset FFT");
-    _multiply_by_coset(a, g);
-    FFT(a);
+    assert(a.size() == this->m);
+    _basic_radix2_batch_FFT(std::vector<std::vector<FieldT>*>(1, &a), omega, FieldT::one(), g);
     leave_block("Execute coset FFT");
 }
 
@@ -70,6 +70,30 @@ void basic_radix2_domain<FieldT>::icosetFFT(std::vector<FieldT> &a, const FieldT
     leave_block("Execute inverse coset IFFT");
 }
 
+template<typename FieldT>
+void basic_radix2_domain<FieldT>::unscaled_iFFT(const std::vector<std::vector<FieldT>*> &a)
+{
+    enter_block("Execute unscaled inverse FFTs");
+    for (const std::vector<FieldT> *v : a)
+    {
+        assert(v->size() == this->m);
+    }
+    _basic_radix2_batch_FFT(a, omega.inverse(), FieldT::one(), FieldT::one());
+    leave_block("Execute unscaled inverse FFTs");
+}
+
+template<typename FieldT>
+void basic_radix2_domain<FieldT>::cosetFFT(const std::vector<std::vector<FieldT>*> &a, const FieldT &g, const FieldT &c)
+{
+    enter_block("Execute coset FFTs");
+    for (const std::vector<FieldT> *v : a)
+    {
+        assert(v->size() == this->m);
+    }
+    _basic_radix2_batch_FFT(a, omega, c, g);
+    leave_block("Execute coset FFTs");
+}
+
 template<typename FieldT>
 std::vector<FieldT> basic_radix2_domain<FieldT>::lagrange_coeffs(const FieldT &t)
 {
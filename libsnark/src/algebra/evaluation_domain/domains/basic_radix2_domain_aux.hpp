@@ -15,8 +15,59 @@
 #ifndef BASIC_RADIX2_DOMAIN_AUX_HPP_
 #define BASIC_RADIX2_DOMAIN_AUX_HPP_
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace libsnark {
 
+/**
+ * Precomputed data for the FFT of size n over S={omega^{0},...,omega^{n-1}}:
+ * the bit-reversal permutation, and the twiddle factors of each radix-4 stage.
+ *
+ * The tables only depend on n and omega, so they are cached and shared by all
+ * the FFTs over the same domain (e.g., by the FFTs of every proof). The cache
+ * keeps the max_cached most recently used tables, and can be emptied with
+ * clear_cache when memory is short.
+ */
+template<typename FieldT>
+class basic_radix2_fft_tables {
+public:
+    const size_t n;
+    const FieldT omega;
+
+    /* the primitive 4-th root of unity omega^{n/4} (if n >= 4) */
+    FieldT imag;
+
+    /* bitrev[k] = bitreverse(k, log2(n)) */
+    std::vector<uint32_t> bitrev;
+
+    /* for the radix-4 stage of each quarter-size m, in increasing order,
+       the triples (w^j, w^{2j}, w^{3j}) for j = 0,...,m-1, where w is a
+       primitive 4m-th root of unity */
+    std::vector<FieldT> twiddles;
+
+    /* a domain needs up to four: forward and inverse, of size n or of the
+       rows and columns of the four-step FFT */
+    static const size_t max_cached = 4;
+
+    basic_radix2_fft_tables(const size_t n, const FieldT &omega);
+
+    /**
+     * Return the (cached) tables for the FFT of size n over the powers of omega.
+     */
+    static std::shared_ptr<const basic_radix2_fft_tables<FieldT> > get(const size_t n, const FieldT &omega);
+
+    /**
+     * Drop all the cached tables; those still in use are freed once done.
+     */
+    static void clear_cache();
+private:
+    static std::mutex cache_mutex;
+    static std::vector<std::shared_ptr<const basic_radix2_fft_tables<FieldT> > > cache;
+};
+
 /**
  * Compute the radix-2 FFT of the vector a over the set S={omega^{0},...,omega^{m-1}}.
  */
@@ -29,6 +80,15 @@ void _basic_radix2_FFT(std::vector<FieldT> &a, const FieldT &omega);
 template<typename FieldT>
 void _parallel_basic_radix2_FFT(std::vector<FieldT> &a, const FieldT &omega);
 
+/**
+ * Compute the radix-2 FFT, over the set S={omega^{0},...,omega^{m-1}}, of each of the
+ * vectors in a after multiplying its i-th entry by c*g^i. The FFTs are computed
+ * together, and the multiplication is merged into their first pass.
+ */
+template<typename FieldT>
+void _basic_radix2_batch_FFT(const std::vector<std::vector<FieldT>*> &a, const FieldT &omega,
+                             const FieldT &c, const FieldT &g);
+
 /**
  * Translate the vector a to a coset defined by g.
  */
@@ -14,7 +14,9 @@
 #ifndef BASIC_RADIX2_DOMAIN_AUX_TCC_
 #define BASIC_RADIX2_DOMAIN_AUX_TCC_
 
+#include <algorithm>
 #include <cassert>
+#include <mutex>
 #ifdef MULTICORE
 #include <omp.h>
 #endif
@@ -30,153 +32,426 @@ namespace libsnark {
 #define _basic_radix2_FFT _basic_serial_radix2_FFT
 #endif
 
-/*
- Below we make use of pseudocode from [CLRS 2n Ed, pp. 864].
- Also, note that it's the caller's responsibility to multiply by 1/N.
- */
 template<typename FieldT>
-void _basic_serial_radix2_FFT(std::vector<FieldT> &a, const FieldT &omega)
+basic_radix2_fft_tables<FieldT>::basic_radix2_fft_tables(const size_t n, const FieldT &omega) :
+    n(n), omega(omega), imag(FieldT::one())
 {
-    const size_t n = a.size(), logn = log2(n);
-    assert(n == (1u << logn));
+    const size_t logn = log2(n);
+    assert(n == (1ul << logn));
+    assert(n <= (1ul << 32));
 
-    /* swapping in place (from Storer's book) */
+    bitrev.resize(n);
     for (size_t k = 0; k < n; ++k)
     {
-        const size_t rk = bitreverse(k, logn);
-        if (k < rk)
-            std::swap(a[k], a[rk]);
+        bitrev[k] = bitreverse(k, logn);
     }
 
-    size_t m = 1; // invariant: m = 2^{s-1}
-    for (size_t s = 1; s <= logn; ++s)
+    if (n >= 4)
     {
-        // w_m is 2^s-th root of unity now
-        const FieldT w_m = omega^(n/(2*m));
+        imag = omega^(n/4);
+    }
 
-        asm volatile ("/* pre-inner */");
-        for (size_t k = 0; k < n; k += 2*m)
+    /* an odd number of stages starts with a radix-2 stage, which needs no twiddles */
+    twiddles.reserve(n);
+    for (size_t m = (logn % 2 == 1 ? 2 : 1); m < n; m *= 4)
+    {
+        const FieldT w = omega^(n/(4*m));
+        FieldT wj = FieldT::one();
+        for (size_t j = 0; j < m; ++j)
         {
-            FieldT w = FieldT::one();
-            for (size_t j = 0; j < m; ++j)
-            {
-                const FieldT t = w * a[k+j+m];
-                a[k+j+m] = a[k+j] - t;
-                a[k+j] += t;
-                w *= w_m;
-            }
+            const FieldT w2j = wj.squared();
+            twiddles.emplace_back(wj);
+            twiddles.emplace_back(w2j);
+            twiddles.emplace_back(w2j * wj);
+            wj *= w;
         }
-        asm volatile ("/* post-inner */");
-        m *= 2;
     }
 }
 
 template<typename FieldT>
-void _basic_parallel_radix2_FFT_inner(std::vector<FieldT> &a, const FieldT &omega, const size_t log_cpus)
+std::mutex basic_radix2_fft_tables<FieldT>::cache_mutex;
+
+template<typename FieldT>
+std::vector<std::shared_ptr<const basic_radix2_fft_tables<FieldT> > > basic_radix2_fft_tables<FieldT>::cache;
+
+template<typename FieldT>
+std::shared_ptr<const basic_radix2_fft_tables<FieldT> > basic_radix2_fft_tables<FieldT>::get(const size_t n, const FieldT &omega)
 {
-    const size_t num_cpus = 1ul<<log_cpus;
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    /* the cache is in order of use, the most recent last */
+    for (size_t i = 0; i < cache.size(); ++i)
+    {
+        if (cache[i]->n == n && cache[i]->omega == omega)
+        {
+            std::rotate(cache.begin() + i, cache.begin() + i + 1, cache.end());
+            return cache.back();
+        }
+    }
 
-    const size_t m = a.size();
-    const size_t log_m = log2(m);
-    assert(m == 1ul<<log_m);
+    if (cache.size() == max_cached)
+    {
+        cache.erase(cache.begin());
+    }
+    cache.emplace_back(std::make_shared<const basic_radix2_fft_tables<FieldT> >(n, omega));
+    return cache.back();
+}
+
+template<typename FieldT>
+void basic_radix2_fft_tables<FieldT>::clear_cache()
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.clear();
+}
 
-    if (log_m < log_cpus)
+/*
+ The radix-2 butterflies of half-size m and then 2m, merged, on len entries
+ x0[t], x1[t], x2[t], x3[t] whose last three have been multiplied by their
+ twiddles into y1[t], y2[t], y3[t]; y2 and y3 are overwritten.
+ */
+template<typename FieldT>
+void _basic_radix4_butterflies(FieldT *x0, FieldT *x1, FieldT *x2, FieldT *x3,
+                               const FieldT *y1, FieldT *y2, FieldT *y3, const FieldT &imag, const size_t len)
+{
+    for (size_t t = 0; t < len; ++t)
     {
-        _basic_serial_radix2_FFT(a, omega);
-        return;
+        const FieldT s1 = y2[t] + y3[t];
+        y3[t] = y2[t] - y3[t];
+        y2[t] = s1;
     }
+    batch_mul(y3, y3, &imag, 0, len);
+
+    for (size_t t = 0; t < len; ++t)
+    {
+        const FieldT s0 = x0[t] + y1[t];
+        const FieldT d0 = x0[t] - y1[t];
+
+        x0[t] = s0 + y2[t];
+        x1[t] = d0 + y3[t];
+        x2[t] = s0 - y2[t];
+        x3[t] = d0 - y3[t];
+    }
+}
+
+/*
+ Below we make use of pseudocode from [CLRS 2n Ed, pp. 864], with pairs of
+ consecutive radix-2 stages merged into radix-4 stages, which halves the
+ number of passes over the data.
+
+ The FFT is applied in place to each of the width consecutive columns of the
+ matrix whose rows start at a, a+stride, a+2*stride, etc.; butterflies on a
+ row are applied to all the columns at once, so that blocks of columns stay
+ in cache when the stride is large.
+
+ If scale is not null, the entry in row k and column b is first multiplied
+ by scale[b] * scale_step^k; this is merged into the bit-reversal pass.
+ */
+template<typename FieldT>
+void _basic_radix2_FFT_columns(FieldT *a, const size_t stride, const size_t width, const basic_radix2_fft_tables<FieldT> &tables,
+                               const FieldT *scale = nullptr, const FieldT &scale_step = FieldT::one())
+{
+    const size_t n = tables.n, logn = log2(n);
+
+    /* swapping in place (from Storer's book) */
+    if (scale == nullptr)
+    {
+        for (size_t k = 0; k < n; ++k)
+        {
+            const size_t rk = tables.bitrev[k];
+            if (k < rk)
+            {
+                for (size_t b = 0; b < width; ++b)
+                {
+                    std::swap(a[k*stride+b], a[rk*stride+b]);
+                }
+            }
+        }
+    }
+    else
+    {
+        /* invariant: factor[b] = scale[b] * scale_step^k */
+        std::vector<FieldT> factor(scale, scale + width);
+        for (size_t k = 0; k < n; ++k)
+        {
+            const size_t rk = tables.bitrev[k];
+            /* the original row k is still in row k if rk >= k, and has been swapped into row rk otherwise */
+            FieldT *row = a + (rk < k ? rk : k)*stride;
+            batch_mul(row, row, factor.data(), 1, width);
+            batch_mul(factor.data(), factor.data(), &scale_step, 0, width);
+            if (k < rk)
+            {
+                for (size_t b = 0; b < width; ++b)
+                {
+                    std::swap(a[k*stride+b], a[rk*stride+b]);
+                }
+            }
+        }
+    }
+
+    size_t m = 1;
+    if (logn % 2 == 1)
+    {
+        for (size_t k = 0; k < n; k += 2)
+        {
+            FieldT *x0 = a + k*stride, *x1 = x0 + stride;
+            for (size_t b = 0; b < width; ++b)
+            {
+                const FieldT t = x1[b];
+                x1[b] = x0[b] - t;
+                x0[b] += t;
+            }
+        }
+        m = 2;
+    }
+
+    /*
+     invariant: the columns consist of the FFTs of size m of their consecutive blocks
 
-    enter_block("Shuffle inputs");
-    std::vector<std::vector<FieldT> > tmp(num_cpus);
-    for (size_t j = 0; j < num_cpus; ++j)
+     The twiddle products are computed by batch_mul, batch elements at a
+     time: along j, with the twiddles read at a stride of 3, for a single
+     contiguous column, and along the columns otherwise.
+     */
+    const size_t batch = 16;
+    FieldT y1[batch], y2[batch], y3[batch];
+    const FieldT &imag = tables.imag;
+    const FieldT *w = tables.twiddles.data();
+    for (; m < n; m *= 4)
     {
-        tmp[j].resize(1ul<<(log_m-log_cpus), FieldT::zero());
+        for (size_t k = 0; k < n; k += 4*m)
+        {
+            if (width == 1 && stride == 1)
+            {
+                for (size_t j0 = 0; j0 < m; j0 += batch)
+                {
+                    const size_t len = std::min(batch, m - j0);
+                    FieldT *x0 = a + k + j0, *x1 = x0 + m, *x2 = x1 + m, *x3 = x2 + m;
+                    batch_mul(y1, x1, w + 3*j0 + 1, 3, len);
+                    batch_mul(y2, x2, w + 3*j0, 3, len);
+                    batch_mul(y3, x3, w + 3*j0 + 2, 3, len);
+                    _basic_radix4_butterflies(x0, x1, x2, x3, y1, y2, y3, imag, len);
+                }
+            }
+            else
+            {
+                for (size_t j = 0; j < m; ++j)
+                {
+                    const FieldT &w_j = w[3*j], &w_2j = w[3*j+1], &w_3j = w[3*j+2];
+                    FieldT *x0 = a + (k+j)*stride, *x1 = x0 + m*stride, *x2 = x1 + m*stride, *x3 = x2 + m*stride;
+                    for (size_t b0 = 0; b0 < width; b0 += batch)
+                    {
+                        const size_t len = std::min(batch, width - b0);
+                        batch_mul(y1, x1 + b0, &w_2j, 0, len);
+                        batch_mul(y2, x2 + b0, &w_j, 0, len);
+                        batch_mul(y3, x3 + b0, &w_3j, 0, len);
+                        _basic_radix4_butterflies(x0 + b0, x1 + b0, x2 + b0, x3 + b0, y1, y2, y3, imag, len);
+                    }
+                }
+            }
+        }
+        w += 3*m;
     }
+}
+
+template<typename FieldT>
+void _basic_serial_radix2_FFT(std::vector<FieldT> &a, const FieldT &omega)
+{
+    const size_t n = a.size(), logn = log2(n);
+    assert(n == (1u << logn));
+
+    const std::shared_ptr<const basic_radix2_fft_tables<FieldT> > tables = basic_radix2_fft_tables<FieldT>::get(n, omega);
+    _basic_radix2_FFT_columns(a.data(), 1, 1, *tables);
+}
+
+template<typename FieldT>
+void _basic_serial_radix2_coset_FFT(std::vector<FieldT> &a, const FieldT &omega, const FieldT &c, const FieldT &g)
+{
+    const size_t n = a.size(), logn = log2(n);
+    assert(n == (1u << logn));
 
+    const std::shared_ptr<const basic_radix2_fft_tables<FieldT> > tables = basic_radix2_fft_tables<FieldT>::get(n, omega);
+    const bool scaled = !(c == FieldT::one() && g == FieldT::one());
+    _basic_radix2_FFT_columns(a.data(), 1, 1, *tables, scaled ? &c : nullptr, g);
+}
+
+/*
+ The four-step FFT of [Bailey 1990]: each vector in a, of size n = rows * cols,
+ is viewed as a rows x cols matrix (with cols = rows or cols = 2*rows); we then
+ 1) compute the FFTs of size rows of its columns, in blocks of consecutive columns,
+ 2) multiply the entry (i, j) by omega^{i*j},
+ 3) compute the FFTs of size cols of its rows, and
+ 4) transpose it in place, which puts the result in the natural order.
+ All steps are parallelized over blocks of columns or rows of all the vectors
+ at once, for any number of threads, and need no temporary copy of a.
+ If c != 1 or g != 1, a[i] is first multiplied by c*g^i, in step 1.
+ */
+template<typename FieldT>
+void _basic_four_step_radix2_FFT(const std::vector<std::vector<FieldT>*> &a, const FieldT &omega,
+                                 const FieldT &c = FieldT::one(), const FieldT &g = FieldT::one())
+{
+    const size_t count = a.size();
+    const size_t n = a[0]->size(), logn = log2(n);
+    assert(n == (1u << logn));
+
+    const size_t rows = 1ul<<(logn/2), cols = n / rows;
+    const size_t block = 16;
+    assert(rows >= block);
+
+    const std::shared_ptr<const basic_radix2_fft_tables<FieldT> > column_tables = basic_radix2_fft_tables<FieldT>::get(rows, omega^cols);
+    const std::shared_ptr<const basic_radix2_fft_tables<FieldT> > row_tables = basic_radix2_fft_tables<FieldT>::get(cols, omega^rows);
+    const bool scaled = !(c == FieldT::one() && g == FieldT::one());
+    const FieldT g_cols = g^cols;
+
+    enter_block("Execute column FFTs");
+    const size_t column_blocks = cols / block;
 #ifdef MULTICORE
     #pragma omp parallel for
 #endif
-    for (size_t j = 0; j < num_cpus; ++j)
+    for (size_t idx = 0; idx < count * column_blocks; ++idx)
     {
-        const FieldT omega_j = omega^j;
-        const FieldT omega_step = omega^(j<<(log_m - log_cpus));
+        FieldT *v = a[idx / column_blocks]->data();
+        const size_t j0 = (idx % column_blocks) * block;
 
-        FieldT elt = FieldT::one();
-        for (size_t i = 0; i < 1ul<<(log_m - log_cpus); ++i)
+        FieldT scale[block];
+        if (scaled)
         {
-            for (size_t s = 0; s < num_cpus; ++s)
+            scale[0] = c * (g^j0);
+            for (size_t b = 1; b < block; ++b)
             {
-                // invariant: elt is omega^(j*idx)
-                const size_t idx = (i + (s<<(log_m - log_cpus))) % (1u << log_m);
-                tmp[j][i] += a[idx] * elt;
-                elt *= omega_step;
+                scale[b] = scale[b-1] * g;
             }
-            elt *= omega_j;
         }
-    }
-    leave_block("Shuffle inputs");
+        _basic_radix2_FFT_columns(v + j0, cols, block, *column_tables, scaled ? scale : nullptr, g_cols);
 
-    enter_block("Execute sub-FFTs");
-    const FieldT omega_num_cpus = omega^num_cpus;
+        FieldT w[block], w_i[block];
+        w[0] = omega^j0;
+        for (size_t b = 1; b < block; ++b)
+        {
+            w[b] = w[b-1] * omega;
+        }
+        for (size_t b = 0; b < block; ++b)
+        {
+            w_i[b] = w[b];
+        }
 
+        /* invariant: w_i[b] = omega^{i*(j0+b)} */
+        for (size_t i = 1; i < rows; ++i)
+        {
+            batch_mul(v + i*cols + j0, v + i*cols + j0, w_i, 1, block);
+            batch_mul(w_i, w_i, w, 1, block);
+        }
+    }
+    leave_block("Execute column FFTs");
+
+    enter_block("Execute row FFTs");
 #ifdef MULTICORE
     #pragma omp parallel for
 #endif
-    for (size_t j = 0; j < num_cpus; ++j)
+    for (size_t idx = 0; idx < count * rows; ++idx)
     {
-        _basic_serial_radix2_FFT(tmp[j], omega_num_cpus);
+        FieldT *v = a[idx / rows]->data();
+        const size_t i = idx % rows;
+        _basic_radix2_FFT_columns(v + i*cols, 1, 1, *row_tables);
     }
-    leave_block("Execute sub-FFTs");
-
-    enter_block("Re-shuffle outputs");
+    leave_block("Execute row FFTs");
 
+    enter_block("Transpose");
+    /* the rows x cols matrix is a square matrix of e-tuples, which is transposed in tiles */
+    const size_t e = cols / rows;
+    const size_t tile_rows = rows / block;
 #ifdef MULTICORE
-    #pragma omp parallel for
+    #pragma omp parallel for schedule(dynamic)
 #endif
-    for (size_t i = 0; i < num_cpus; ++i)
+    for (size_t idx = 0; idx < count * tile_rows; ++idx)
     {
-        for (size_t j = 0; j < 1ul<<(log_m - log_cpus); ++j)
+        FieldT *v = a[idx / tile_rows]->data();
+        const size_t i0 = (idx % tile_rows) * block;
+        for (size_t j0 = i0; j0 < rows; j0 += block)
         {
-            // now: i = idx >> (log_m - log_cpus) and j = idx % (1u << (log_m - log_cpus)), for idx = ((i<<(log_m-log_cpus))+j) % (1u << log_m)
-            a[(j<<log_cpus) + i] = tmp[i][j];
+            for (size_t i = i0; i < i0 + block; ++i)
+            {
+                for (size_t j = (i0 == j0 ? i + 1 : j0); j < j0 + block; ++j)
+                {
+                    for (size_t t = 0; t < e; ++t)
+                    {
+                        std::swap(v[i*cols + e*j + t], v[j*cols + e*i + t]);
+                    }
+                }
+            }
         }
     }
-    leave_block("Re-shuffle outputs");
+
+    /* row i now holds the rows e*i,...,e*i+e-1 of the transpose, interleaved */
+    if (e == 2)
+    {
+#ifdef MULTICORE
+        #pragma omp parallel
+#endif
+        {
+            std::vector<FieldT> odd(rows);
+#ifdef MULTICORE
+            #pragma omp for
+#endif
+            for (size_t idx = 0; idx < count * rows; ++idx)
+            {
+                FieldT *row = a[idx / rows]->data() + (idx % rows)*cols;
+                for (size_t j = 0; j < rows; ++j)
+                {
+                    odd[j] = row[2*j+1];
+                    row[j] = row[2*j];
+                }
+                std::copy(odd.begin(), odd.end(), row + rows);
+            }
+        }
+    }
+    leave_block("Transpose");
 }
 
 template<typename FieldT>
-void _basic_parallel_radix2_FFT(std::vector<FieldT> &a, const FieldT &omega)
+void _basic_radix2_batch_FFT(const std::vector<std::vector<FieldT>*> &a, const FieldT &omega,
+                             const FieldT &c, const FieldT &g)
 {
 #ifdef MULTICORE
     const size_t num_cpus = omp_get_max_threads();
 #else
     const size_t num_cpus = 1;
 #endif
-    const size_t log_cpus = ((num_cpus & (num_cpus - 1)) == 0 ? log2(num_cpus) : log2(num_cpus) - 1);
 
 #ifdef DEBUG
-    print_indent(); printf("* Invoking parallel FFT on 2^%zu CPUs (omp_get_max_threads = %zu)\n", log_cpus, num_cpus);
+    print_indent(); printf("* Invoking %zu FFTs on %zu CPUs\n", a.size(), num_cpus);
 #endif
 
-    if (log_cpus == 0)
+    if (a.empty())
+    {
+        return;
+    }
+
+    /* small FFTs are not worth the extra passes */
+    if (num_cpus == 1 || a[0]->size() < (1ul << 10))
     {
-        _basic_serial_radix2_FFT(a, omega);
+        for (std::vector<FieldT> *v : a)
+        {
+            _basic_serial_radix2_coset_FFT(*v, omega, c, g);
+        }
     }
     else
     {
-        _basic_parallel_radix2_FFT_inner(a, omega, log_cpus);
+        _basic_four_step_radix2_FFT(a, omega, c, g);
     }
 }
 
+template<typename FieldT>
+void _basic_parallel_radix2_FFT(std::vector<FieldT> &a, const FieldT &omega)
+{
+    _basic_radix2_batch_FFT(std::vector<std::vector<FieldT>*>(1, &a), omega, FieldT::one(), FieldT::one());
+}
+
 template<typename FieldT>
 void _multiply_by_coset(std::vector<FieldT> &a, const FieldT &g)
 {
     //enter_block("Multiply by coset");
-    FieldT u = g;
-    for (size_t i = 1; i < a.size(); ++i)
+    if (a.size() > 1)
     {
-        a[i] *= u;
-        u *= g;
+        batch_mul_by_powers(a.data() + 1, a.size() - 1, g, g);
     }
     //leave_block("Multiply by coset");
 }
@@ -27,6 +27,7 @@
 #define EVALUATION_DOMAIN_HPP_
 
 #include <memory>
+#include <vector>
 
 namespace libsnark {
 
@@ -71,6 +72,21 @@ public:
      */
     virtual void icosetFFT(std::vector<FieldT> &a, const FieldT &g) = 0;
 
+    /**
+     * Compute the inverse FFT, over the domain S, of each of the vectors in a,
+     * without the final multiplication by 1/m (i.e., compute m times the
+     * inverse FFT). Domains may override this to compute the transforms
+     * together; by default, they are computed one at a time with iFFT.
+     */
+    virtual void unscaled_iFFT(const std::vector<std::vector<FieldT>*> &a);
+
+    /**
+     * Compute the FFT, over the domain g*S, of c times each of the vectors in a.
+     * Domains may override this to compute the transforms together, with the
+     * multiplication by c for free; by default, they use cosetFFT one at a time.
+     */
+    virtual void cosetFFT(const std::vector<std::vector<FieldT>*> &a, const FieldT &g, const FieldT &c);
+
     /**
      * Evaluate all Lagrange polynomials.
      *
@@ -89,6 +89,33 @@ std::shared_ptr<evaluation_domain<FieldT> > get_evaluation_domain(const size_t m
     return result;
 }
 
+template<typename FieldT>
+void evaluation_domain<FieldT>::unscaled_iFFT(const std::vector<std::vector<FieldT>*> &a)
+{
+    const FieldT m_field = FieldT(this->m);
+    for (std::vector<FieldT> *v : a)
+    {
+        iFFT(*v);
+        for (FieldT &x : *v)
+        {
+            x *= m_field;
+        }
+    }
+}
+
+template<typename FieldT>
+void evaluation_domain<FieldT>::cosetFFT(const std::vector<std::vector<FieldT>*> &a, const FieldT &g, const FieldT &c)
+{
+    for (std::vector<FieldT> *v : a)
+    {
+        for (FieldT &x : *v)
+        {
+            x *= c;
+        }
+        cosetFFT(*v, g);
+    }
+}
+
 template<typename FieldT>
 FieldT lagrange_eval(const size_t m, const std::vector<FieldT> &domain, const FieldT &t, const size_t idx)
 {
@@ -0,0 +1,178 @@
+/**
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+#include <cassert>
+#include <vector>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "common/profiling.hpp"
+#include "algebra/curves/alt_bn128/alt_bn128_pp.hpp"
+#include "algebra/evaluation_domain/evaluation_domain.hpp"
+
+using namespace libsnark;
+
+typedef alt_bn128_Fr FieldT;
+
+std::vector<FieldT> random_vector(const size_t n)
+{
+    std::vector<FieldT> v(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        v[i] = FieldT::random_element();
+    }
+    return v;
+}
+
+/* the evaluations of the polynomial with coefficients a at c * omega^i */
+std::vector<FieldT> naive_DFT(const std::vector<FieldT> &a, const FieldT &omega, const FieldT &c)
+{
+    const size_t n = a.size();
+    std::vector<FieldT> result(n, FieldT::zero());
+    FieldT x = c;
+    for (size_t i = 0; i < n; ++i)
+    {
+        /* Horner's rule */
+        for (size_t j = n; j-- > 0;)
+        {
+            result[i] = result[i] * x + a[j];
+        }
+        x *= omega;
+    }
+    return result;
+}
+
+/*
+ Check FFT, iFFT, cosetFFT and icosetFFT, and the batched unscaled_iFFT and
+ cosetFFT, against a naive DFT. In MULTICORE builds, the sizes of at least
+ 2^10 go through the four-step FFT.
+ */
+void test_fft_against_naive(const size_t logn)
+{
+    const size_t n = 1ul << logn;
+    basic_radix2_domain<FieldT> domain(n);
+    const FieldT omega = get_root_of_unity<FieldT>(n);
+    const FieldT g = FieldT::multiplicative_generator;
+    const FieldT c = FieldT::random_element();
+
+    const std::vector<FieldT> a = random_vector(n);
+    const std::vector<FieldT> expected = naive_DFT(a, omega, FieldT::one());
+    const std::vector<FieldT> expected_coset = naive_DFT(a, omega, g);
+
+    std::vector<FieldT> b = a;
+    domain.FFT(b);
+    assert(b == expected);
+    domain.iFFT(b);
+    assert(b == a);
+
+    b = a;
+    domain.cosetFFT(b, g);
+    assert(b == expected_coset);
+    domain.icosetFFT(b, g);
+    assert(b == a);
+
+    /* m * iFFT(FFT(a)) = m * a */
+    std::vector<FieldT> b0 = expected, b1 = expected_coset;
+    domain.unscaled_iFFT({ &b0, &b1 });
+    const FieldT m = FieldT(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        assert(b0[i] == m * a[i]);
+    }
+
+    /* the default of evaluation_domain, one transform at a time */
+    b0 = expected;
+    domain.evaluation_domain<FieldT>::unscaled_iFFT({ &b0 });
+    for (size_t i = 0; i < n; ++i)
+    {
+        assert(b0[i] == m * a[i]);
+    }
+
+    /* cosetFFT(c * a) = c * expected_coset, on two vectors at once */
+    b0 = a;
+    b1 = a;
+    domain.cosetFFT({ &b0, &b1 }, g, c);
+    for (size_t i = 0; i < n; ++i)
+    {
+        assert(b0[i] == c * expected_coset[i]);
+        assert(b1[i] == b0[i]);
+    }
+
+    b0 = a;
+    domain.evaluation_domain<FieldT>::cosetFFT({ &b0 }, g, c);
+    for (size_t i = 0; i < n; ++i)
+    {
+        assert(b0[i] == c * expected_coset[i]);
+    }
+}
+
+/*
+ Check the batched coset FFT of larger sizes, too large for the naive DFT,
+ against the FFT of each vector on its own.
+ */
+void test_batch_fft(const size_t logn)
+{
+    const size_t n = 1ul << logn;
+    basic_radix2_domain<FieldT> domain(n);
+    const FieldT g = FieldT::multiplicative_generator;
+    const FieldT c = FieldT::random_element();
+
+    std::vector<std::vector<FieldT> > a(3);
+    std::vector<std::vector<FieldT>*> ptrs;
+    for (auto &v : a)
+    {
+        v = random_vector(n);
+        ptrs.emplace_back(&v);
+    }
+
+    std::vector<std::vector<FieldT> > expected = a;
+    for (auto &v : expected)
+    {
+        for (auto &x : v)
+        {
+            x *= c;
+        }
+        _multiply_by_coset(v, g);
+        _basic_serial_radix2_FFT(v, get_root_of_unity<FieldT>(n));
+    }
+
+    domain.cosetFFT(ptrs, g, c);
+    assert(a == expected);
+
+    domain.unscaled_iFFT(ptrs);
+    const FieldT m_c_inverse = (FieldT(n) * c).inverse();
+    for (auto &v : a)
+    {
+        _multiply_by_coset(v, g.inverse());
+        for (auto &x : v)
+        {
+            x *= m_c_inverse;
+        }
+    }
+    domain.cosetFFT(ptrs, g, c);
+    assert(a == expected);
+}
+
+int main(void)
+{
+    alt_bn128_pp::init_public_params();
+    inhibit_profiling_info = true;
+#ifdef MULTICORE
+    /* the four-step FFT is only used with several threads */
+    omp_set_num_threads(4);
+#endif
+
+    for (size_t logn = 1; logn <= 11; ++logn)
+    {
+        test_fft_against_naive(logn);
+    }
+    test_batch_fft(14);
+    test_batch_fft(15);
+
+    return 0;
+}
@@ -24,6 +24,18 @@ FieldT power(const FieldT &base, const bigint<m> &exponent);
 template<typename FieldT>
 FieldT power(const FieldT &base, const unsigned long exponent);
 
+/**
+ * Fixed-window exponentiation: the powers of base below 2^window_size are
+ * precomputed, after which every window of the exponent costs window_size
+ * squarings and one multiplication, whatever its bits. The sequence of
+ * field operations thus only depends on the length of the exponent, and
+ * neither on its bits nor on base (the field operations themselves need not
+ * be constant-time). The default window size suits exponents of about 256
+ * bits.
+ */
+template<typename FieldT, mp_size_t m>
+FieldT power_fixed_window(const FieldT &base, const bigint<m> &exponent, const size_t window_size=4);
+
 } // libsnark
 
 #include "algebra/exponentiation/exponentiation.tcc"
@@ -14,6 +14,9 @@
 #ifndef EXPONENTIATION_TCC_
 #define EXPONENTIATION_TCC_
 
+#include <algorithm>
+#include <vector>
+
 #include "common/utils.hpp"
 
 namespace libsnark {
@@ -48,6 +51,43 @@ FieldT power(const FieldT &base, const unsigned long exponent)
     return power<FieldT>(base, bigint<1>(exponent));
 }
 
+template<typename FieldT, mp_size_t m>
+FieldT power_fixed_window(const FieldT &base, const bigint<m> &exponent, const size_t window_size)
+{
+    /* powers[k] = base^k */
+    std::vector<FieldT> powers(1ul << window_size);
+    powers[0] = FieldT::one();
+    for (size_t k = 1; k < powers.size(); ++k)
+    {
+        powers[k] = powers[k-1] * base;
+    }
+
+    const size_t num_windows = (exponent.num_bits() + window_size - 1) / window_size;
+
+    FieldT result = FieldT::one();
+
+    for (size_t w = num_windows; w-- > 0; )
+    {
+        if (w != num_windows - 1)
+        {
+            for (size_t i = 0; i < window_size; ++i)
+            {
+                result = result.squared();
+            }
+        }
+
+        size_t digit = 0;
+        for (size_t i = window_size; i-- > 0; )
+        {
+            digit = 2 * digit + (exponent.test_bit(w * window_size + i) ? 1 : 0);
+        }
+
+        result = result * powers[digit];
+    }
+
+    return result;
+}
+
 } // libsnark
 
 #endif // EXPONENTIATION_TCC_
@@ -42,9 +42,25 @@ bit_vector convert_field_element_to_bit_vector(const FieldT &el, const size_t bi
 template<typename FieldT>
 FieldT convert_bit_vector_to_field_element(const bit_vector &v);
 
+/*
+ inverts the elements of vec[0..count) in place, leaving the zeros as they are;
+ the elements are split into chunks, processed in parallel, which each share a
+ single inversion
+ */
+template<typename FieldT>
+void batch_invert(FieldT *vec, const size_t count);
+
 template<typename FieldT>
 void batch_invert(std::vector<FieldT> &vec);
 
+/* sets out[i] = a[i] * b[i*b_stride] for i < count; out may be equal to a, or to b if b_stride is 1 */
+template<typename FieldT>
+void batch_mul(FieldT *out, const FieldT *a, const FieldT *b, const size_t b_stride, const size_t count);
+
+/* multiplies a[i] by first * step^i, for i < count */
+template<typename FieldT>
+void batch_mul_by_powers(FieldT *a, const size_t count, const FieldT &first, const FieldT &step);
+
 } // libsnark
 #include "algebra/fields/field_utils.tcc"
 
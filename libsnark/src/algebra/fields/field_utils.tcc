@@ -10,6 +10,11 @@
 #ifndef FIELD_UTILS_TCC_
 #define FIELD_UTILS_TCC_
 
+#include <algorithm>
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
 #include "common/utils.hpp"
 
 namespace libsnark {
@@ -155,29 +160,99 @@ FieldT convert_bit_vector_to_field_element(const bit_vector &v)
 }
 
 template<typename FieldT>
-void batch_invert(std::vector<FieldT> &vec)
+void _batch_invert_serial(FieldT *vec, const size_t count)
 {
+    /* prod[i] is the product of the nonzero elements before i */
     std::vector<FieldT> prod;
-    prod.reserve(vec.size());
+    prod.reserve(count);
 
     FieldT acc = FieldT::one();
 
-    for (auto el : vec)
+    for (size_t i = 0; i < count; ++i)
     {
-        assert(!el.is_zero());
         prod.emplace_back(acc);
-        acc = acc * el;
+        if (!vec[i].is_zero())
+        {
+            acc = acc * vec[i];
+        }
     }
 
     FieldT acc_inverse = acc.inverse();
 
-    for (long i = vec.size()-1; i >= 0; --i)
+    for (long i = count-1; i >= 0; --i)
     {
+        if (vec[i].is_zero())
+        {
+            continue;
+        }
         const FieldT old_el = vec[i];
         vec[i] = acc_inverse * prod[i];
         acc_inverse = acc_inverse * old_el;
     }
 }
 
+template<typename FieldT>
+void batch_invert(FieldT *vec, const size_t count)
+{
+#ifdef MULTICORE
+    /* an inversion costs a few hundred multiplications, so chunks are kept
+       large, and small batches, or batches within a parallel region, are
+       done at once */
+    const size_t min_chunk_size = 1ul << 12;
+    const size_t num_chunks = (omp_in_parallel() ? 1 : std::max<size_t>(1, std::min<size_t>(omp_get_max_threads(), count / min_chunk_size)));
+#else
+    const size_t num_chunks = 1;
+#endif
+    const size_t chunk_size = (count + num_chunks - 1) / num_chunks;
+
+#ifdef MULTICORE
+#pragma omp parallel for if (num_chunks > 1)
+#endif
+    for (size_t c = 0; c < num_chunks; ++c)
+    {
+        const size_t begin = std::min(c * chunk_size, count), end = std::min(begin + chunk_size, count);
+        _batch_invert_serial(vec + begin, end - begin);
+    }
+}
+
+template<typename FieldT>
+void batch_invert(std::vector<FieldT> &vec)
+{
+    batch_invert(vec.data(), vec.size());
+}
+
+template<typename FieldT>
+void batch_mul(FieldT *out, const FieldT *a, const FieldT *b, const size_t b_stride, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = a[i] * b[i*b_stride];
+    }
+}
+
+template<typename FieldT>
+void batch_mul_by_powers(FieldT *a, const size_t count, const FieldT &first, const FieldT &step)
+{
+    /* the powers are kept for a block at a time, and advanced by step^block */
+    const size_t block = 64;
+    FieldT powers[block];
+    powers[0] = first;
+    for (size_t i = 1; i < block && i < count; ++i)
+    {
+        powers[i] = powers[i-1] * step;
+    }
+    const FieldT step_to_block = step^block;
+
+    for (size_t i = 0; i < count; i += block)
+    {
+        const size_t len = std::min(block, count - i);
+        batch_mul(a + i, a + i, powers, 1, len);
+        if (i + block < count)
+        {
+            batch_mul(powers, powers, &step_to_block, 0, block);
+        }
+    }
+}
+
 } // libsnark
 #endif // FIELD_UTILS_TCC_
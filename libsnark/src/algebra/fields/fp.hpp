@@ -24,6 +24,15 @@ std::ostream& operator<<(std::ostream &, const Fp_model<n, modulus>&);
 template<mp_size_t n, const bigint<n>& modulus>
 std::istream& operator>>(std::istream &, Fp_model<n, modulus> &);
 
+/**
+ * Sets out[i] = a[i] * b[i*b_stride] for i < count, using the vector kernels
+ * of fp_vector.hpp for the fields of four limbs where the CPU supports them.
+ * out may be equal to a, or to b if b_stride is 1.
+ */
+template<mp_size_t n, const bigint<n>& modulus>
+void batch_mul(Fp_model<n, modulus> *out, const Fp_model<n, modulus> *a, const Fp_model<n, modulus> *b,
+               const size_t b_stride, const size_t count);
+
 /**
  * Arithmetic in the finite field F[p], for prime p of fixed length.
  *
@@ -88,6 +97,10 @@ public:
     bool operator!=(const Fp_model& other) const;
     bool is_zero() const;
 
+    /* equality and cond ? a : b, computed without branching on the values */
+    bool equals_branchless(const Fp_model& other) const;
+    static Fp_model select_branchless(const bool cond, const Fp_model& a, const Fp_model& b);
+
     void print() const;
 
     Fp_model& operator+=(const Fp_model& other);
@@ -176,6 +189,36 @@ bigint<n> Fp_model<n, modulus>::Rsquared;
 template<mp_size_t n, const bigint<n>& modulus>
 bigint<n> Fp_model<n, modulus>::Rcubed;
 
+/**
+ * A double-width, unreduced product of elements of F[p].
+ *
+ * The formulas of the extension fields add and subtract such products, and
+ * Montgomery-reduce only once per output coefficient ("lazy reduction").
+ * The 2n limbs hold an integer T < p * R, for R = W^n, which stands for the
+ * element of F[p] whose Montgomery representation is T * R^{-1} (mod p).
+ * The product of two elements of F[p] is of this form, and sums and
+ * differences are brought back into this range by subtracting or adding
+ * p * R, which needs 2p < R.
+ */
+template<mp_size_t n, const bigint<n>& modulus>
+class Fp_dbl_model {
+public:
+    typedef Fp_model<n, modulus> my_Fp;
+
+    bigint<2*n> repr;
+
+    Fp_dbl_model() {};
+    Fp_dbl_model(const my_Fp &a, const my_Fp &b); // the product a * b
+
+    Fp_dbl_model& operator+=(const Fp_dbl_model &other);
+    Fp_dbl_model& operator-=(const Fp_dbl_model &other);
+    Fp_dbl_model operator+(const Fp_dbl_model &other) const;
+    Fp_dbl_model operator-(const Fp_dbl_model &other) const;
+    Fp_dbl_model mul_by_ulong(const unsigned long c) const; // by additions, for small c
+
+    my_Fp reduce() const;
+};
+
 } // libsnark
 #include "algebra/fields/fp.tcc"
 
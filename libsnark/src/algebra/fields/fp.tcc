@@ -15,7 +15,9 @@
 
 #include "algebra/fields/fp_aux.tcc"
 #include "algebra/fields/field_utils.hpp"
+#include "algebra/fields/fp_vector.hpp"
 #include "common/assert_except.hpp"
+#include "common/cpu_features.hpp"
 
 namespace libsnark {
 
@@ -52,6 +54,12 @@ void Fp_model<n,modulus>::mul_reduce(const bigint<n> &other)
              : "cc", "memory", "%rax");
         mpn_copyi(this->mont_repr.data, res+n, n);
     }
+    else if (n == 4 && cpu_has_mulx_adx && (modulus.data[n-1] >> 62) == 0)
+    { // use the "CIOS method" with MULX and two carry chains
+        MULX_4_BY_4_MONT_MUL(this->mont_repr.data[0], this->mont_repr.data[1],
+                             this->mont_repr.data[2], this->mont_repr.data[3],
+                             this->mont_repr.data, other.data, inv, modulus.data);
+    }
     else if (n == 4)
     { // use asm-optimized "CIOS method"
 
@@ -260,6 +268,30 @@ bool Fp_model<n,modulus>::is_zero() const
     return (this->mont_repr.is_zero()); // zero maps to zero
 }
 
+template<mp_size_t n, const bigint<n>& modulus>
+bool Fp_model<n,modulus>::equals_branchless(const Fp_model& other) const
+{
+    /* the representations are fully reduced, so they are equal iff the elements are */
+    mp_limb_t diff = 0;
+    for (mp_size_t i = 0; i < n; ++i)
+    {
+        diff |= this->mont_repr.data[i] ^ other.mont_repr.data[i];
+    }
+    return (diff == 0);
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_model<n,modulus> Fp_model<n,modulus>::select_branchless(const bool cond, const Fp_model& a, const Fp_model& b)
+{
+    const mp_limb_t mask = -(mp_limb_t) cond;
+    Fp_model<n,modulus> r;
+    for (mp_size_t i = 0; i < n; ++i)
+    {
+        r.mont_repr.data[i] = (a.mont_repr.data[i] & mask) | (b.mont_repr.data[i] & ~mask);
+    }
+    return r;
+}
+
 template<mp_size_t n, const bigint<n>& modulus>
 void Fp_model<n,modulus>::print() const
 {
@@ -611,6 +643,14 @@ Fp_model<n,modulus> Fp_model<n,modulus>::squared() const
         mpn_copyi(r.mont_repr.data, res+n, n);
         return r;
     }
+    else if (n == 4 && cpu_has_mulx_adx && (modulus.data[n-1] >> 62) == 0)
+    { // use MULX squaring, computing the cross products once
+        Fp_model<n, modulus> r;
+        MULX_4_MONT_SQR(r.mont_repr.data[0], r.mont_repr.data[1],
+                        r.mont_repr.data[2], r.mont_repr.data[3],
+                        this->mont_repr.data, inv, modulus.data);
+        return r;
+    }
     else
 #endif
     {
@@ -704,6 +744,18 @@ Fp_model<n, modulus> Fp_model<n,modulus>::random_element() /// returns random el
 template<mp_size_t n, const bigint<n>& modulus>
 Fp_model<n,modulus> Fp_model<n,modulus>::sqrt() const
 {
+    if (Fp_model<n,modulus>::s == 1)
+    {
+        /* for modulus = 3 mod 4, (*this)^((modulus+1)/4) is the square root,
+           zero included, computed with a fixed sequence of operations */
+        const Fp_model<n,modulus> x = (*this) * power_fixed_window(*this, Fp_model<n,modulus>::t_minus_1_over_2);
+        if (x.squared() != *this)
+        {
+            assert_except(0);
+        }
+        return x;
+    }
+
     if (is_zero()) {
         return *this;
     }
@@ -712,7 +764,7 @@ Fp_model<n,modulus> Fp_model<n,modulus>::sqrt() const
 
     size_t v = Fp_model<n,modulus>::s;
     Fp_model<n,modulus> z = Fp_model<n,modulus>::nqr_to_t;
-    Fp_model<n,modulus> w = (*this)^Fp_model<n,modulus>::t_minus_1_over_2;
+    Fp_model<n,modulus> w = power_fixed_window(*this, Fp_model<n,modulus>::t_minus_1_over_2);
     Fp_model<n,modulus> x = (*this) * w;
     Fp_model<n,modulus> b = x * w; // b = (*this)^t
 
@@ -786,5 +838,209 @@ std::istream& operator>>(std::istream &in, Fp_model<n, modulus> &p)
     return in;
 }
 
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_dbl_model<n,modulus>::Fp_dbl_model(const Fp_model<n,modulus> &a, const Fp_model<n,modulus> &b)
+{
+#ifdef PROFILE_OP_COUNTS
+    my_Fp::mul_cnt++;
+#endif
+#if defined(__x86_64__) && defined(USE_ASM)
+    if (n == 4 && cpu_has_mulx_adx)
+    {
+        MULX_4_BY_4_MUL(this->repr.data, a.mont_repr.data, b.mont_repr.data);
+    }
+    else
+#endif
+    {
+        mpn_mul_n(this->repr.data, a.mont_repr.data, b.mont_repr.data, n);
+    }
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_dbl_model<n,modulus>& Fp_dbl_model<n,modulus>::operator+=(const Fp_dbl_model<n,modulus> &other)
+{
+#ifdef PROFILE_OP_COUNTS
+    my_Fp::add_cnt++;
+#endif
+    mp_limb_t *high = this->repr.data + n;
+#if defined(__x86_64__) && defined(USE_ASM)
+    if (n == 4)
+    {
+        /* A and B point to the high halves; the sum is below 2p * R, and
+           p * R is subtracted if its high half is at least p */
+        __asm__
+            ("movq    -32(%[B]), %%rax        \n\t"
+             "addq    %%rax, -32(%[A])        \n\t"
+             ADD_NEXTADD(-24)
+             ADD_NEXTADD(-16)
+             ADD_NEXTADD(-8)
+             ADD_NEXTADD(0)
+             ADD_NEXTADD(8)
+             ADD_NEXTADD(16)
+             ADD_NEXTADD(24)
+
+             ADD_CMP(24)
+             ADD_CMP(16)
+             ADD_CMP(8)
+             ADD_CMP(0)
+
+             "subtract%=:                     \n\t"
+             ADD_FIRSTSUB
+             ADD_NEXTSUB(8)
+             ADD_NEXTSUB(16)
+             ADD_NEXTSUB(24)
+             "done%=:                         \n\t"
+             :
+             : [A] "r" (high), [B] "r" (other.repr.data + n), [mod] "r" (modulus.data)
+             : "cc", "memory", "%rax");
+    }
+    else
+#endif
+    {
+        const mp_limb_t carry = mpn_add_n(this->repr.data, this->repr.data, other.repr.data, 2*n);
+        assert(carry == 0);
+        if (mpn_cmp(high, modulus.data, n) >= 0)
+        {
+            mpn_sub_n(high, high, modulus.data, n);
+        }
+    }
+    return *this;
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_dbl_model<n,modulus>& Fp_dbl_model<n,modulus>::operator-=(const Fp_dbl_model<n,modulus> &other)
+{
+#ifdef PROFILE_OP_COUNTS
+    my_Fp::sub_cnt++;
+#endif
+    mp_limb_t *high = this->repr.data + n;
+#if defined(__x86_64__) && defined(USE_ASM)
+    if (n == 4)
+    {
+        /* A and B point to the high halves; p * R is added if the
+           difference is negative */
+        __asm__
+            ("movq    -32(%[B]), %%rax        \n\t"
+             "subq    %%rax, -32(%[A])        \n\t"
+             SUB_NEXTSUB(-24)
+             SUB_NEXTSUB(-16)
+             SUB_NEXTSUB(-8)
+             SUB_NEXTSUB(0)
+             SUB_NEXTSUB(8)
+             SUB_NEXTSUB(16)
+             SUB_NEXTSUB(24)
+
+             "jnc     done%=\n\t"
+
+             SUB_FIRSTADD
+             SUB_NEXTADD(8)
+             SUB_NEXTADD(16)
+             SUB_NEXTADD(24)
+
+             "done%=:\n\t"
+             :
+             : [A] "r" (high), [B] "r" (other.repr.data + n), [mod] "r" (modulus.data)
+             : "cc", "memory", "%rax");
+    }
+    else
+#endif
+    {
+        if (mpn_sub_n(this->repr.data, this->repr.data, other.repr.data, 2*n))
+        {
+            /* the carry out cancels the borrow */
+            mpn_add_n(high, high, modulus.data, n);
+        }
+    }
+    return *this;
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_dbl_model<n,modulus> Fp_dbl_model<n,modulus>::operator+(const Fp_dbl_model<n,modulus> &other) const
+{
+    Fp_dbl_model<n, modulus> r(*this);
+    return (r += other);
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_dbl_model<n,modulus> Fp_dbl_model<n,modulus>::operator-(const Fp_dbl_model<n,modulus> &other) const
+{
+    Fp_dbl_model<n, modulus> r(*this);
+    return (r -= other);
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_dbl_model<n,modulus> Fp_dbl_model<n,modulus>::mul_by_ulong(const unsigned long c) const
+{
+    assert(c != 0);
+    Fp_dbl_model<n, modulus> r(*this);
+    for (long i = (long) (8*sizeof(c)) - __builtin_clzl(c) - 2; i >= 0; --i)
+    {
+        r += r;
+        if (c & (1ul << i))
+        {
+            r += *this;
+        }
+    }
+    return r;
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp_model<n,modulus> Fp_dbl_model<n,modulus>::reduce() const
+{
+    Fp_model<n, modulus> r;
+#if defined(__x86_64__) && defined(USE_ASM)
+    if (n == 4 && cpu_has_mulx_adx && (modulus.data[n-1] >> 62) == 0)
+    {
+        MULX_4_MONT_REDUCE(r.mont_repr.data[0], r.mont_repr.data[1],
+                           r.mont_repr.data[2], r.mont_repr.data[3],
+                           this->repr.data, my_Fp::inv, modulus.data);
+    }
+    else
+#endif
+    {
+        /* as in Fp_model::mul_reduce */
+        mp_limb_t res[2*n];
+        mpn_copyi(res, this->repr.data, 2*n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            mp_limb_t k = my_Fp::inv * res[i];
+            mp_limb_t carryout = mpn_addmul_1(res+i, modulus.data, n, k);
+            carryout = mpn_add_1(res+n+i, res+n+i, n-i, carryout);
+            assert(carryout == 0);
+        }
+
+        if (mpn_cmp(res+n, modulus.data, n) >= 0)
+        {
+            const mp_limb_t borrow = mpn_sub(res+n, res+n, n, modulus.data, n);
+            assert(borrow == 0);
+        }
+
+        mpn_copyi(r.mont_repr.data, res+n, n);
+    }
+    return r;
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+void batch_mul(Fp_model<n, modulus> *out, const Fp_model<n, modulus> *a, const Fp_model<n, modulus> *b,
+               const size_t b_stride, const size_t count)
+{
+#ifdef PROFILE_OP_COUNTS
+    Fp_model<n, modulus>::mul_cnt += count;
+#endif
+    /* the kernels read the elements as arrays of limbs */
+    static_assert(sizeof(Fp_model<n, modulus>) == sizeof(bigint<n>), "Fp_model must hold only its representation");
+    if (n == 4 && (modulus.data[n-1] >> 62) == 0 && fp4_vector_lanes() != 0 && count >= fp4_vector_lanes())
+    {
+        static const fp4_vector_modulus p(modulus.data, Fp_model<n, modulus>::inv);
+        fp4_vector_mul(out->mont_repr.data, a->mont_repr.data, b->mont_repr.data, b_stride, count, p);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = a[i] * b[i*b_stride];
+    }
+}
+
 } // libsnark
 #endif // FP_TCC_
@@ -184,18 +184,44 @@ Fp12_2over3over2_model<n,modulus> Fp12_2over3over2_model<n,modulus>::cyclotomic_
 
     my_Fp2 t0, t1, t2, t3, t4, t5, tmp;
 
-    // t0 + t1*y = (z0 + z1*y)^2 = a^2
-    tmp = z0 * z1;
-    t0 = (z0 + z1) * (z0 + my_Fp6::non_residue * z1) - tmp - my_Fp6::non_residue * tmp;
-    t1 = tmp + tmp;
-    // t2 + t3*y = (z2 + z3*y)^2 = b^2
-    tmp = z2 * z3;
-    t2 = (z2 + z3) * (z2 + my_Fp6::non_residue * z3) - tmp - my_Fp6::non_residue * tmp;
-    t3 = tmp + tmp;
-    // t4 + t5*y = (z4 + z5*y)^2 = c^2
-    tmp = z4 * z5;
-    t4 = (z4 + z5) * (z4 + my_Fp6::non_residue * z5) - tmp - my_Fp6::non_residue * tmp;
-    t5 = tmp + tmp;
+    if (my_Fp6::non_residue_small_c0 != 0 && my_Fp2::non_residue_is_minus_one)
+    {
+        /* the same squares, as x^2 + non_residue*y^2 and (x + y)^2 - x^2 - y^2,
+           accumulated unreduced */
+        typedef Fp2_dbl_model<n, modulus> my_Fp2_dbl;
+        my_Fp2_dbl xsq, ysq;
+
+        // t0 + t1*y = (z0 + z1*y)^2 = a^2
+        xsq = my_Fp2_dbl::squared(z0);
+        ysq = my_Fp2_dbl::squared(z1);
+        t0 = (xsq + my_Fp6::mul_by_non_residue(ysq)).reduce();
+        t1 = (my_Fp2_dbl::squared(z0 + z1) - xsq - ysq).reduce();
+        // t2 + t3*y = (z2 + z3*y)^2 = b^2
+        xsq = my_Fp2_dbl::squared(z2);
+        ysq = my_Fp2_dbl::squared(z3);
+        t2 = (xsq + my_Fp6::mul_by_non_residue(ysq)).reduce();
+        t3 = (my_Fp2_dbl::squared(z2 + z3) - xsq - ysq).reduce();
+        // t4 + t5*y = (z4 + z5*y)^2 = c^2
+        xsq = my_Fp2_dbl::squared(z4);
+        ysq = my_Fp2_dbl::squared(z5);
+        t4 = (xsq + my_Fp6::mul_by_non_residue(ysq)).reduce();
+        t5 = (my_Fp2_dbl::squared(z4 + z5) - xsq - ysq).reduce();
+    }
+    else
+    {
+        // t0 + t1*y = (z0 + z1*y)^2 = a^2
+        tmp = z0 * z1;
+        t0 = (z0 + z1) * (z0 + my_Fp6::non_residue * z1) - tmp - my_Fp6::non_residue * tmp;
+        t1 = tmp + tmp;
+        // t2 + t3*y = (z2 + z3*y)^2 = b^2
+        tmp = z2 * z3;
+        t2 = (z2 + z3) * (z2 + my_Fp6::non_residue * z3) - tmp - my_Fp6::non_residue * tmp;
+        t3 = tmp + tmp;
+        // t4 + t5*y = (z4 + z5*y)^2 = c^2
+        tmp = z4 * z5;
+        t4 = (z4 + z5) * (z4 + my_Fp6::non_residue * z5) - tmp - my_Fp6::non_residue * tmp;
+        t5 = tmp + tmp;
+    }
 
     // for A
 
@@ -247,6 +273,11 @@ Fp12_2over3over2_model<n,modulus> Fp12_2over3over2_model<n,modulus>::mul_by_024(
 
        return (*this) * a;
     */
+    if (my_Fp6::non_residue_small_c0 != 0 && my_Fp2::non_residue_is_minus_one)
+    {
+        return mul_by_024_lazy(ell_0, ell_VW, ell_VV);
+    }
+
     my_Fp2 z0 = this->c0.c0;
     my_Fp2 z1 = this->c0.c1;
     my_Fp2 z2 = this->c0.c2;
@@ -319,6 +350,80 @@ Fp12_2over3over2_model<n,modulus> Fp12_2over3over2_model<n,modulus>::mul_by_024(
 
 }
 
+template<mp_size_t n, const bigint<n>& modulus>
+Fp12_2over3over2_model<n,modulus> Fp12_2over3over2_model<n,modulus>::mul_by_024_lazy(const Fp2_model<n, modulus> &ell_0,
+                                                                                     const Fp2_model<n, modulus> &ell_VW,
+                                                                                     const Fp2_model<n, modulus> &ell_VV) const
+{
+    /* mul_by_024, with the products of Fp2 elements accumulated unreduced,
+       and reduced once per output coefficient */
+    typedef Fp2_dbl_model<n, modulus> my_Fp2_dbl;
+
+    const my_Fp2 &z0 = this->c0.c0;
+    const my_Fp2 &z1 = this->c0.c1;
+    const my_Fp2 &z2 = this->c0.c2;
+    const my_Fp2 &z3 = this->c1.c0;
+    const my_Fp2 &z4 = this->c1.c1;
+    const my_Fp2 &z5 = this->c1.c2;
+
+    const my_Fp2 &x0 = ell_0;
+    const my_Fp2 &x2 = ell_VV;
+    const my_Fp2 &x4 = ell_VW;
+
+    my_Fp2 r0, r1, r2, r3, r4, r5;
+    my_Fp2_dbl T3, T4, S1;
+
+    const my_Fp2_dbl D0(z0, x0);
+    const my_Fp2_dbl D2(z2, x2);
+    const my_Fp2_dbl D4(z4, x4);
+    const my_Fp2 t2 = z0 + z4;
+    const my_Fp2 t1 = z0 + z2;
+    const my_Fp2 s0 = z1 + z3 + z5;
+
+    // For z.a_.a_ = z0.
+    S1 = my_Fp2_dbl(z1, x2);
+    T3 = S1 + D4;
+    r0 = (my_Fp6::mul_by_non_residue(T3) + D0).reduce();
+
+    // For z.a_.b_ = z1
+    T3 = my_Fp2_dbl(z5, x4);
+    S1 += T3;
+    T3 += D2;
+    T4 = my_Fp6::mul_by_non_residue(T3);
+    T3 = my_Fp2_dbl(z1, x0);
+    S1 += T3;
+    T4 += T3;
+    r1 = T4.reduce();
+
+    // For z.a_.c_ = z2
+    T3 = my_Fp2_dbl(t1, x0 + x2) - D0 - D2;
+    T4 = my_Fp2_dbl(z3, x4);
+    S1 += T4;
+    T3 += T4;
+    r2 = T3.reduce();
+
+    // For z.b_.a_ = z3
+    T3 = my_Fp2_dbl(z2 + z4, x2 + x4) - D2 - D4;
+    T4 = my_Fp6::mul_by_non_residue(T3);
+    T3 = my_Fp2_dbl(z3, x0);
+    S1 += T3;
+    T4 += T3;
+    r3 = T4.reduce();
+
+    // For z.b_.b_ = z4
+    T3 = my_Fp2_dbl(z5, x2);
+    S1 += T3;
+    T4 = my_Fp6::mul_by_non_residue(T3);
+    T3 = my_Fp2_dbl(t2, x0 + x4) - D0 - D4;
+    T4 += T3;
+    r4 = T4.reduce();
+
+    // For z.b_.c_ = z5.
+    r5 = (my_Fp2_dbl(s0, x0 + x2 + x4) - S1).reduce();
+
+    return Fp12_2over3over2_model<n,modulus>(my_Fp6(r0,r1,r2),my_Fp6(r3,r4,r5));
+}
+
 template<mp_size_t n, const bigint<n>& modulus, mp_size_t m>
 Fp12_2over3over2_model<n, modulus> operator^(const Fp12_2over3over2_model<n, modulus> &self, const bigint<m> &exponent)
 {
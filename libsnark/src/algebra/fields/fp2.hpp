@@ -41,6 +41,7 @@ public:
     static bigint<2*n> t;  // with t odd
     static bigint<2*n> t_minus_1_over_2; // (t-1)/2
     static my_Fp non_residue; // X^4-non_residue irreducible over Fp; used for constructing Fp2 = Fp[X] / (X^2 - non_residue)
+    static bool non_residue_is_minus_one; // enables the lazy-reduction formulas of Fp2_dbl_model
     static Fp2_model<n, modulus> nqr; // a quadratic nonresidue in Fp2
     static Fp2_model<n, modulus> nqr_to_t; // nqr^t
     static my_Fp Frobenius_coeffs_c1[2]; // non_residue^((modulus^i-1)/2) for i=0,1
@@ -68,6 +69,7 @@ public:
     Fp2_model inverse() const;
     Fp2_model Frobenius_map(unsigned long power) const;
     Fp2_model sqrt() const; // HAS TO BE A SQUARE (else does not terminate)
+    Fp2_model sqrt_complex() const; // for non_residue = -1 and modulus = 3 mod 4; used by sqrt; fixed sequence of operations
     Fp2_model squared_karatsuba() const;
     Fp2_model squared_complex() const;
 
@@ -81,6 +83,32 @@ public:
     friend std::istream& operator>> <n, modulus>(std::istream &in, Fp2_model<n, modulus> &el);
 };
 
+/**
+ * A double-width, unreduced element of F[p^2], made of two Fp_dbl_model
+ * coefficients, which are only reduced at the end. Its products need the
+ * non-residue to be -1, so that they are sums of products of F[p].
+ */
+template<mp_size_t n, const bigint<n>& modulus>
+class Fp2_dbl_model {
+public:
+    typedef Fp2_model<n, modulus> my_Fp2;
+    typedef Fp_dbl_model<n, modulus> my_Fp_dbl;
+
+    my_Fp_dbl c0, c1;
+    Fp2_dbl_model() {};
+    Fp2_dbl_model(const my_Fp_dbl& c0, const my_Fp_dbl& c1) : c0(c0), c1(c1) {};
+    Fp2_dbl_model(const my_Fp2 &a, const my_Fp2 &b); // the product a * b
+
+    static Fp2_dbl_model squared(const my_Fp2 &a);
+
+    Fp2_dbl_model& operator+=(const Fp2_dbl_model &other);
+    Fp2_dbl_model& operator-=(const Fp2_dbl_model &other);
+    Fp2_dbl_model operator+(const Fp2_dbl_model &other) const;
+    Fp2_dbl_model operator-(const Fp2_dbl_model &other) const;
+
+    my_Fp2 reduce() const;
+};
+
 template<mp_size_t n, const bigint<n>& modulus>
 std::ostream& operator<<(std::ostream& out, const std::vector<Fp2_model<n, modulus> > &v);
 
@@ -105,6 +133,9 @@ bigint<2*n> Fp2_model<n, modulus>::t_minus_1_over_2;
 template<mp_size_t n, const bigint<n>& modulus>
 Fp_model<n, modulus> Fp2_model<n, modulus>::non_residue;
 
+template<mp_size_t n, const bigint<n>& modulus>
+bool Fp2_model<n, modulus>::non_residue_is_minus_one;
+
 template<mp_size_t n, const bigint<n>& modulus>
 Fp2_model<n, modulus> Fp2_model<n, modulus>::nqr;
 
@@ -72,6 +72,11 @@ Fp2_model<n, modulus> operator*(const Fp_model<n, modulus> &lhs, const Fp2_model
 template<mp_size_t n, const bigint<n>& modulus>
 Fp2_model<n,modulus> Fp2_model<n,modulus>::operator*(const Fp2_model<n,modulus> &other) const
 {
+    if (non_residue_is_minus_one)
+    {
+        return Fp2_dbl_model<n,modulus>(*this, other).reduce();
+    }
+
     /* Devegili OhEig Scott Dahab --- Multiplication and Squaring on Pairing-Friendly Fields.pdf; Section 3 (Karatsuba) */
     const my_Fp
         &A = other.c0, &B = other.c1,
@@ -115,6 +120,13 @@ Fp2_model<n,modulus> Fp2_model<n,modulus>::squared_complex() const
     const my_Fp &a = this->c0, &b = this->c1;
     const my_Fp ab = a * b;
 
+    if (non_residue_is_minus_one)
+    {
+        /* (a + b*U)^2 = (a + b)*(a - b) + 2ab*U, with one reduction per coefficient */
+        return Fp2_model<n,modulus>((a + b) * (a - b),
+                                    ab + ab);
+    }
+
     return Fp2_model<n,modulus>((a + b) * (a + non_residue * b) - ab - non_residue * ab,
                                 ab + ab);
 }
@@ -145,6 +157,11 @@ Fp2_model<n,modulus> Fp2_model<n,modulus>::Frobenius_map(unsigned long power) co
 template<mp_size_t n, const bigint<n>& modulus>
 Fp2_model<n,modulus> Fp2_model<n,modulus>::sqrt() const
 {
+    if (non_residue_is_minus_one && my_Fp::s == 1)
+    {
+        return sqrt_complex();
+    }
+
     if (is_zero()) {
         return *this;
     }
@@ -153,7 +170,7 @@ Fp2_model<n,modulus> Fp2_model<n,modulus>::sqrt() const
 
     size_t v = Fp2_model<n,modulus>::s;
     Fp2_model<n,modulus> z = Fp2_model<n,modulus>::nqr_to_t;
-    Fp2_model<n,modulus> w = (*this)^Fp2_model<n,modulus>::t_minus_1_over_2;
+    Fp2_model<n,modulus> w = power_fixed_window(*this, Fp2_model<n,modulus>::t_minus_1_over_2);
     Fp2_model<n,modulus> x = (*this) * w;
     Fp2_model<n,modulus> b = x * w; // b = (*this)^t
 
@@ -201,6 +218,36 @@ Fp2_model<n,modulus> Fp2_model<n,modulus>::sqrt() const
     return x;
 }
 
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_model<n,modulus> Fp2_model<n,modulus>::sqrt_complex() const
+{
+    /* With u^2 = -1 and modulus = 3 mod 4, y = d^((modulus-3)/4) gives
+       d * y^2 = 1 if d is a nonzero square in Fp, with square root d * y, and
+       d * y^2 = -1 if d is not a square. (c0 + c1*u) = (x0 + x1*u)^2 then
+       reduces to delta = x0^2 = (c0 + gamma)/2, with gamma^2 = c0^2 + c1^2,
+       and x1 = c1/(2*x0). If delta is not a square, the other root
+       delta' = (c0 - gamma)/2 = -c1^2/(4*delta) is, and x0 = -c1*y/2,
+       x1 = delta * y. delta is only zero if c1 is, and then delta' = c0 is
+       used instead; zero maps to zero.
+       The sequence of field operations does not depend on the value: the
+       cases are chosen with select_branchless. */
+    static const my_Fp two_inv = my_Fp(2).inverse();
+
+    // asserts unless this is a square
+    const my_Fp gamma = (c0.squared() + c1.squared()).sqrt();
+    const my_Fp delta_plus = (c0 + gamma) * two_inv;
+    const my_Fp delta_minus = (c0 - gamma) * two_inv;
+    const my_Fp delta = my_Fp::select_branchless(delta_plus.equals_branchless(my_Fp::zero()), delta_minus, delta_plus);
+
+    const my_Fp y = power_fixed_window(delta, my_Fp::t_minus_1_over_2);
+    const my_Fp x = delta * y;
+    const my_Fp c1_y_over_2 = c1 * y * two_inv;
+
+    const bool delta_is_square = (x * y).equals_branchless(my_Fp::one());
+    return Fp2_model<n,modulus>(my_Fp::select_branchless(delta_is_square, x, -c1_y_over_2),
+                                my_Fp::select_branchless(delta_is_square, c1_y_over_2, x));
+}
+
 template<mp_size_t n, const bigint<n>& modulus>
 template<mp_size_t m>
 Fp2_model<n,modulus> Fp2_model<n,modulus>::operator^(const bigint<m> &pow) const
@@ -208,6 +255,65 @@ Fp2_model<n,modulus> Fp2_model<n,modulus>::operator^(const bigint<m> &pow) const
     return power<Fp2_model<n, modulus>, m>(*this, pow);
 }
 
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_dbl_model<n,modulus>::Fp2_dbl_model(const Fp2_model<n,modulus> &a, const Fp2_model<n,modulus> &b)
+{
+    assert(my_Fp2::non_residue_is_minus_one);
+
+    /* Karatsuba, as in Fp2_model::operator*, with U^2 = -1 */
+    const my_Fp_dbl aA(a.c0, b.c0);
+    const my_Fp_dbl bB(a.c1, b.c1);
+    this->c0 = aA - bB;
+    this->c1 = my_Fp_dbl(a.c0 + a.c1, b.c0 + b.c1) - aA - bB;
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_dbl_model<n,modulus> Fp2_dbl_model<n,modulus>::squared(const Fp2_model<n,modulus> &a)
+{
+    assert(my_Fp2::non_residue_is_minus_one);
+
+    const my_Fp_dbl ab(a.c0, a.c1);
+    return Fp2_dbl_model<n,modulus>(my_Fp_dbl(a.c0 + a.c1, a.c0 - a.c1),
+                                    ab + ab);
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_dbl_model<n,modulus>& Fp2_dbl_model<n,modulus>::operator+=(const Fp2_dbl_model<n,modulus> &other)
+{
+    this->c0 += other.c0;
+    this->c1 += other.c1;
+    return *this;
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_dbl_model<n,modulus>& Fp2_dbl_model<n,modulus>::operator-=(const Fp2_dbl_model<n,modulus> &other)
+{
+    this->c0 -= other.c0;
+    this->c1 -= other.c1;
+    return *this;
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_dbl_model<n,modulus> Fp2_dbl_model<n,modulus>::operator+(const Fp2_dbl_model<n,modulus> &other) const
+{
+    return Fp2_dbl_model<n,modulus>(this->c0 + other.c0,
+                                    this->c1 + other.c1);
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_dbl_model<n,modulus> Fp2_dbl_model<n,modulus>::operator-(const Fp2_dbl_model<n,modulus> &other) const
+{
+    return Fp2_dbl_model<n,modulus>(this->c0 - other.c0,
+                                    this->c1 - other.c1);
+}
+
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_model<n,modulus> Fp2_dbl_model<n,modulus>::reduce() const
+{
+    return Fp2_model<n,modulus>(this->c0.reduce(),
+                                this->c1.reduce());
+}
+
 template<mp_size_t n, const bigint<n>& modulus>
 std::ostream& operator<<(std::ostream &out, const Fp2_model<n, modulus> &el)
 {
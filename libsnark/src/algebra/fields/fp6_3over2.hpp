@@ -39,6 +39,7 @@ public:
     typedef Fp2_model<n, modulus> my_Fp2;
 
     static my_Fp2 non_residue;
+    static unsigned long non_residue_small_c0; // if nonzero, non_residue = non_residue_small_c0 + U, for the lazy-reduction formulas
     static my_Fp2 Frobenius_coeffs_c1[6]; // non_residue^((modulus^i-1)/3)   for i=0,1,2,3,4,5
     static my_Fp2 Frobenius_coeffs_c2[6]; // non_residue^((2*modulus^i-2)/3) for i=0,1,2,3,4,5
 
@@ -66,6 +67,7 @@ public:
     Fp6_3over2_model Frobenius_map(unsigned long power) const;
 
     static my_Fp2 mul_by_non_residue(const my_Fp2 &elt);
+    static Fp2_dbl_model<n, modulus> mul_by_non_residue(const Fp2_dbl_model<n, modulus> &elt);
 
     template<mp_size_t m>
     Fp6_3over2_model operator^(const bigint<m> &other) const;
@@ -92,6 +94,9 @@ Fp6_3over2_model<n, modulus> operator*(const Fp2_model<n, modulus> &lhs, const F
 template<mp_size_t n, const bigint<n>& modulus>
 Fp2_model<n, modulus> Fp6_3over2_model<n, modulus>::non_residue;
 
+template<mp_size_t n, const bigint<n>& modulus>
+unsigned long Fp6_3over2_model<n, modulus>::non_residue_small_c0;
+
 template<mp_size_t n, const bigint<n>& modulus>
 Fp2_model<n, modulus> Fp6_3over2_model<n, modulus>::Frobenius_coeffs_c1[6];
 
@@ -19,6 +19,16 @@ Fp2_model<n, modulus> Fp6_3over2_model<n,modulus>::mul_by_non_residue(const Fp2_
     return Fp2_model<n, modulus>(non_residue * elt);
 }
 
+template<mp_size_t n, const bigint<n>& modulus>
+Fp2_dbl_model<n, modulus> Fp6_3over2_model<n,modulus>::mul_by_non_residue(const Fp2_dbl_model<n, modulus> &elt)
+{
+    assert(non_residue_small_c0 != 0 && my_Fp2::non_residue_is_minus_one);
+
+    /* (c + U) * (x + y*U) = (c*x - y) + (x + c*y)*U, by additions only */
+    return Fp2_dbl_model<n, modulus>(elt.c0.mul_by_ulong(non_residue_small_c0) - elt.c1,
+                                     elt.c1.mul_by_ulong(non_residue_small_c0) + elt.c0);
+}
+
 template<mp_size_t n, const bigint<n>& modulus>
 Fp6_3over2_model<n,modulus> Fp6_3over2_model<n,modulus>::zero()
 {
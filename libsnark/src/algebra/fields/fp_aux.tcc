@@ -385,5 +385,230 @@ namespace libsnark {
          : [modprime] "r" (inv_), [res] "r" (res_), [mod] "r" (mod_) \
          : "%rax", "%rdx", "cc", "memory")
 
+/*
+  Montgomery multiplication and squaring of 4-limb numbers with MULX, which
+  leaves the flags alone, and ADCX/ADOX, which carry through CF and OF only,
+  so that the low and high halves of the partial products are added in two
+  independent carry chains. These need BMI2 and ADX, and fp.tcc only uses
+  them when cpu_has_mulx_adx is set.
+
+  The modulus must be below 2^254: then the running sum of the CIOS method
+  never needs a sixth limb, and the five limbs t0..t4 are kept in registers.
+  Each reduction step leaves t0 at zero, so the next row reuses it as its
+  top limb, and the register names rotate from one row to the next.
+  %[dx] must be bound to %rdx, the implicit operand of MULX.
+*/
+
+#define MULX_MUL_ROW(i, t0, t1, t2, t3, t4)                             \
+    "movq    " STR((i*8)) "(%[B]), %[dx]    \n\t"                       \
+    "xorl    %k[" #t4 "], %k[" #t4 "]       \n\t"                       \
+    "mulxq   0(%[A]), %[lo], %[hi]          \n\t"                       \
+    "adoxq   %[lo], %[" #t0 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t1 "]              \n\t"                       \
+    "mulxq   8(%[A]), %[lo], %[hi]          \n\t"                       \
+    "adoxq   %[lo], %[" #t1 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t2 "]              \n\t"                       \
+    "mulxq   16(%[A]), %[lo], %[hi]         \n\t"                       \
+    "adoxq   %[lo], %[" #t2 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t3 "]              \n\t"                       \
+    "mulxq   24(%[A]), %[lo], %[hi]         \n\t"                       \
+    "adoxq   %[lo], %[" #t3 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t4 "]              \n\t"                       \
+    "movl    $0, %k[lo]                     \n\t"                       \
+    "adoxq   %[lo], %[" #t4 "]              # t4:t3:t2:t1:t0 += A * B[i] \n\t"
+
+#define MULX_REDUCE_STEP(t0, t1, t2, t3, t4)                            \
+    "movq    %[" #t0 "], %[dx]              \n\t"                       \
+    "imulq   %[inv], %[dx]                  # u <- t0 * inv \n\t"       \
+    "xorl    %k[lo], %k[lo]                 \n\t"                       \
+    "mulxq   0(%[M]), %[lo], %[hi]          \n\t"                       \
+    "adoxq   %[lo], %[" #t0 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t1 "]              \n\t"                       \
+    "mulxq   8(%[M]), %[lo], %[hi]          \n\t"                       \
+    "adoxq   %[lo], %[" #t1 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t2 "]              \n\t"                       \
+    "mulxq   16(%[M]), %[lo], %[hi]         \n\t"                       \
+    "adoxq   %[lo], %[" #t2 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t3 "]              \n\t"                       \
+    "mulxq   24(%[M]), %[lo], %[hi]         \n\t"                       \
+    "adoxq   %[lo], %[" #t3 "]              \n\t"                       \
+    "adcxq   %[hi], %[" #t4 "]              \n\t"                       \
+    "movl    $0, %k[lo]                     \n\t"                       \
+    "adoxq   %[lo], %[" #t4 "]              # t4:t3:t2:t1:0 <- t + M * u \n\t"
+
+/* t <- t - M if t >= M, without branches; s0..s3 are scratch */
+#define MULX_FINAL_SUB(t0, t1, t2, t3, s0, s1, s2, s3)                  \
+    "movq    %[" #t0 "], %[" #s0 "]         \n\t"                       \
+    "subq    0(%[M]), %[" #s0 "]            \n\t"                       \
+    "movq    %[" #t1 "], %[" #s1 "]         \n\t"                       \
+    "sbbq    8(%[M]), %[" #s1 "]            \n\t"                       \
+    "movq    %[" #t2 "], %[" #s2 "]         \n\t"                       \
+    "sbbq    16(%[M]), %[" #s2 "]           \n\t"                       \
+    "movq    %[" #t3 "], %[" #s3 "]         \n\t"                       \
+    "sbbq    24(%[M]), %[" #s3 "]           \n\t"                       \
+    "cmovncq %[" #s0 "], %[" #t0 "]         \n\t"                       \
+    "cmovncq %[" #s1 "], %[" #t1 "]         \n\t"                       \
+    "cmovncq %[" #s2 "], %[" #t2 "]         \n\t"                       \
+    "cmovncq %[" #s3 "], %[" #t3 "]         \n\t"
+
+#define MULX_4_BY_4_MONT_MUL(r0_, r1_, r2_, r3_, A_, B_, inv_, M_)     \
+    do {                                                                \
+        mp_limb_t t4_, lo_, hi_, dx_;                                   \
+        __asm__                                                         \
+            ("xorl    %k[t0], %k[t0]           \n\t"                    \
+             "xorl    %k[t1], %k[t1]           \n\t"                    \
+             "xorl    %k[t2], %k[t2]           \n\t"                    \
+             "xorl    %k[t3], %k[t3]           \n\t"                    \
+             MULX_MUL_ROW(0, t0, t1, t2, t3, t4)                        \
+             MULX_REDUCE_STEP(t0, t1, t2, t3, t4)                       \
+             MULX_MUL_ROW(1, t1, t2, t3, t4, t0)                        \
+             MULX_REDUCE_STEP(t1, t2, t3, t4, t0)                       \
+             MULX_MUL_ROW(2, t2, t3, t4, t0, t1)                        \
+             MULX_REDUCE_STEP(t2, t3, t4, t0, t1)                       \
+             MULX_MUL_ROW(3, t3, t4, t0, t1, t2)                        \
+             MULX_REDUCE_STEP(t3, t4, t0, t1, t2)                       \
+             MULX_FINAL_SUB(t4, t0, t1, t2, t3, lo, hi, dx)             \
+             : [t0] "=&r" (r1_), [t1] "=&r" (r2_), [t2] "=&r" (r3_),    \
+               [t3] "=&r" (t4_), [t4] "=&r" (r0_),                      \
+               [lo] "=&r" (lo_), [hi] "=&r" (hi_), [dx] "=&d" (dx_)     \
+             : [A] "r" (A_), [B] "r" (B_), [inv] "rm" (inv_), [M] "r" (M_) \
+             : "cc", "memory");                                         \
+    } while (0)
+
+/*
+  Squaring computes the six cross products once, then doubles them in the
+  CF chain while adding the four squares in the OF chain. It then reduces the low half of the 8-limb square in four
+  steps and adds the high half, which is below M since the input is.
+*/
+#define MULX_4_MONT_SQR(r0_, r1_, r2_, r3_, A_, inv_, M_)              \
+    do {                                                                \
+        mp_limb_t a_ = (mp_limb_t) (A_);                                \
+        mp_limb_t p3_, p4_, p5_, p6_, p7_, lo_, hi_, dx_;               \
+        __asm__                                                         \
+            ("movq    0(%[A]), %[dx]           \n\t"                    \
+             "mulxq   8(%[A]), %[p1], %[p2]    \n\t"                    \
+             "mulxq   16(%[A]), %[lo], %[p3]   \n\t"                    \
+             "addq    %[lo], %[p2]             \n\t"                    \
+             "mulxq   24(%[A]), %[lo], %[p4]   \n\t"                    \
+             "adcq    %[lo], %[p3]             \n\t"                    \
+             "adcq    $0, %[p4]                # a0 * (a1, a2, a3) \n\t" \
+             "movq    8(%[A]), %[dx]           \n\t"                    \
+             "xorl    %k[p5], %k[p5]           \n\t"                    \
+             "mulxq   16(%[A]), %[lo], %[hi]   \n\t"                    \
+             "adoxq   %[lo], %[p3]             \n\t"                    \
+             "adcxq   %[hi], %[p4]             \n\t"                    \
+             "mulxq   24(%[A]), %[lo], %[hi]   \n\t"                    \
+             "adoxq   %[lo], %[p4]             \n\t"                    \
+             "adcxq   %[hi], %[p5]             \n\t"                    \
+             "movl    $0, %k[lo]               \n\t"                    \
+             "adoxq   %[lo], %[p5]             # + a1 * (a2, a3) \n\t"  \
+             "movq    16(%[A]), %[dx]          \n\t"                    \
+             "mulxq   24(%[A]), %[lo], %[p6]   \n\t"                    \
+             "addq    %[lo], %[p5]             \n\t"                    \
+             "adcq    $0, %[p6]                # + a2 * a3 \n\t"        \
+             "xorl    %k[p7], %k[p7]           \n\t"                    \
+             "movq    0(%[A]), %[dx]           \n\t"                    \
+             "mulxq   %[dx], %[p0], %[hi]      \n\t"                    \
+             "adcxq   %[p1], %[p1]             \n\t"                    \
+             "adoxq   %[hi], %[p1]             \n\t"                    \
+             "movq    8(%[A]), %[dx]           \n\t"                    \
+             "mulxq   %[dx], %[lo], %[hi]      \n\t"                    \
+             "adcxq   %[p2], %[p2]             \n\t"                    \
+             "adoxq   %[lo], %[p2]             \n\t"                    \
+             "adcxq   %[p3], %[p3]             \n\t"                    \
+             "adoxq   %[hi], %[p3]             \n\t"                    \
+             "movq    16(%[A]), %[dx]          \n\t"                    \
+             "mulxq   %[dx], %[lo], %[hi]      \n\t"                    \
+             "adcxq   %[p4], %[p4]             \n\t"                    \
+             "adoxq   %[lo], %[p4]             \n\t"                    \
+             "adcxq   %[p5], %[p5]             \n\t"                    \
+             "adoxq   %[hi], %[p5]             \n\t"                    \
+             "movq    24(%[A]), %[dx]          \n\t"                    \
+             "mulxq   %[dx], %[lo], %[hi]      \n\t"                    \
+             "adcxq   %[p6], %[p6]             \n\t"                    \
+             "adoxq   %[lo], %[p6]             \n\t"                    \
+             "adcxq   %[p7], %[p7]             \n\t"                    \
+             "adoxq   %[hi], %[p7]             # double and add the squares a_i^2 \n\t" \
+             "xorl    %k[A], %k[A]             \n\t"                    \
+             MULX_REDUCE_STEP(p0, p1, p2, p3, A)                        \
+             MULX_REDUCE_STEP(p1, p2, p3, A, p0)                        \
+             MULX_REDUCE_STEP(p2, p3, A, p0, p1)                        \
+             MULX_REDUCE_STEP(p3, A, p0, p1, p2)                        \
+             "addq    %[p4], %[A]              \n\t"                    \
+             "adcq    %[p5], %[p0]             \n\t"                    \
+             "adcq    %[p6], %[p1]             \n\t"                    \
+             "adcq    %[p7], %[p2]             \n\t"                    \
+             MULX_FINAL_SUB(A, p0, p1, p2, p3, lo, hi, dx)              \
+             : [A] "+&r" (a_), [p0] "=&r" (r1_), [p1] "=&r" (r2_),      \
+               [p2] "=&r" (r3_), [p3] "=&r" (p3_), [p4] "=&r" (p4_),    \
+               [p5] "=&r" (p5_), [p6] "=&r" (p6_), [p7] "=&r" (p7_),    \
+               [lo] "=&r" (lo_), [hi] "=&r" (hi_), [dx] "=&d" (dx_)     \
+             : [inv] "rm" (inv_), [M] "r" (M_)                          \
+             : "cc", "memory");                                         \
+        r0_ = a_;                                                       \
+    } while (0)
+
+/*
+  The 8-limb product of two 4-limb numbers, without reduction: the rows of
+  MULX_4_BY_4_MONT_MUL, each of which leaves its lowest limb final. The
+  product is only stored to memory, hence the volatile.
+*/
+#define MULX_4_BY_4_MUL(res_, A_, B_)                                   \
+    do {                                                                \
+        mp_limb_t t0_, t1_, t2_, t3_, t4_, lo_, hi_, dx_;               \
+        __asm__ volatile                                                \
+            ("xorl    %k[t0], %k[t0]           \n\t"                    \
+             "xorl    %k[t1], %k[t1]           \n\t"                    \
+             "xorl    %k[t2], %k[t2]           \n\t"                    \
+             "xorl    %k[t3], %k[t3]           \n\t"                    \
+             MULX_MUL_ROW(0, t0, t1, t2, t3, t4)                        \
+             "movq    %[t0], 0(%[res])         \n\t"                    \
+             MULX_MUL_ROW(1, t1, t2, t3, t4, t0)                        \
+             "movq    %[t1], 8(%[res])         \n\t"                    \
+             MULX_MUL_ROW(2, t2, t3, t4, t0, t1)                        \
+             "movq    %[t2], 16(%[res])        \n\t"                    \
+             MULX_MUL_ROW(3, t3, t4, t0, t1, t2)                        \
+             "movq    %[t3], 24(%[res])        \n\t"                    \
+             "movq    %[t4], 32(%[res])        \n\t"                    \
+             "movq    %[t0], 40(%[res])        \n\t"                    \
+             "movq    %[t1], 48(%[res])        \n\t"                    \
+             "movq    %[t2], 56(%[res])        \n\t"                    \
+             : [t0] "=&r" (t0_), [t1] "=&r" (t1_), [t2] "=&r" (t2_),    \
+               [t3] "=&r" (t3_), [t4] "=&r" (t4_),                      \
+               [lo] "=&r" (lo_), [hi] "=&r" (hi_), [dx] "=&d" (dx_)     \
+             : [res] "r" (res_), [A] "r" (A_), [B] "r" (B_)             \
+             : "cc", "memory");                                         \
+    } while (0)
+
+/*
+  Montgomery reduction of an 8-limb number T < M * 2^256, as at the end of
+  MULX_4_MONT_SQR: the low half is reduced in four steps, to at most M, and
+  the high half, below M, is added.
+*/
+#define MULX_4_MONT_REDUCE(r0_, r1_, r2_, r3_, T_, inv_, M_)           \
+    do {                                                                \
+        mp_limb_t p3_, lo_, hi_, dx_;                                   \
+        __asm__                                                         \
+            ("movq    0(%[T]), %[p0]           \n\t"                    \
+             "movq    8(%[T]), %[p1]           \n\t"                    \
+             "movq    16(%[T]), %[p2]          \n\t"                    \
+             "movq    24(%[T]), %[p3]          \n\t"                    \
+             "xorl    %k[A], %k[A]             \n\t"                    \
+             MULX_REDUCE_STEP(p0, p1, p2, p3, A)                        \
+             MULX_REDUCE_STEP(p1, p2, p3, A, p0)                        \
+             MULX_REDUCE_STEP(p2, p3, A, p0, p1)                        \
+             MULX_REDUCE_STEP(p3, A, p0, p1, p2)                        \
+             "addq    32(%[T]), %[A]           \n\t"                    \
+             "adcq    40(%[T]), %[p0]          \n\t"                    \
+             "adcq    48(%[T]), %[p1]          \n\t"                    \
+             "adcq    56(%[T]), %[p2]          \n\t"                    \
+             MULX_FINAL_SUB(A, p0, p1, p2, p3, lo, hi, dx)              \
+             : [A] "=&r" (r0_), [p0] "=&r" (r1_), [p1] "=&r" (r2_),     \
+               [p2] "=&r" (r3_), [p3] "=&r" (p3_),                      \
+               [lo] "=&r" (lo_), [hi] "=&r" (hi_), [dx] "=&d" (dx_)     \
+             : [T] "r" (T_), [inv] "rm" (inv_), [M] "r" (M_)            \
+             : "cc", "memory");                                         \
+    } while (0)
+
 } // libsnark
 #endif // FP_AUX_TCC_
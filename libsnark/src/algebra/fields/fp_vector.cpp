@@ -0,0 +1,444 @@
+/** @file
+ *****************************************************************************
+ Implementation of vectorized multiplication of arrays of elements of F[p].
+
+ See fp_vector.hpp .
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+/* the AVX-512 intrinsics of GCC 12 start from deliberately undefined vectors */
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include "algebra/fields/fp_vector.hpp"
+#include "common/cpu_features.hpp"
+
+namespace libsnark {
+
+fp4_vector_modulus::fp4_vector_modulus(const mp_limb_t *p, const mp_limb_t inv) : inv(inv)
+{
+    assert((p[3] >> 62) == 0);
+    std::copy(p, p + 4, this->p);
+}
+
+#if defined(__x86_64__)
+
+/*
+  Both kernels compute the Montgomery product of a block of elements in
+  product-scanning form with lazy carries: every partial product of two
+  k-bit limbs is split into its low and high k bits, which are added to the
+  columns of the 2*L-limb product without propagating carries. Since the
+  lanes are 64 bits wide, a column can take all the halves added to it.
+
+  The L reduction steps then clear the low columns one at a time, each after
+  absorbing the carry out of the previous one. With 32-bit limbs, the eight
+  steps divide by 2^256 exactly; with 52-bit limbs, the fifth step only
+  clears 48 bits, so that the result is again divided by 2^256 and is in
+  the Montgomery form of Fp_model<4, p>. The result is less than 2p, and p
+  is subtracted from the lanes where it is not less than p.
+*/
+
+#define TARGET_AVX512IFMA __attribute__((target("avx512f,avx512ifma")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+/* eight elements, in five 52-bit limbs: limb j of element i is lane i of limb[j] */
+struct ifma_block {
+    __m512i limb[5];
+};
+
+struct ifma_modulus {
+    ifma_block p;
+    __m512i inv;
+};
+
+TARGET_AVX512IFMA
+static inline void ifma_split(ifma_block &x, const __m512i x0, const __m512i x1, const __m512i x2, const __m512i x3)
+{
+    const __m512i mask52 = _mm512_set1_epi64((1ull<<52)-1);
+    x.limb[0] = _mm512_and_si512(x0, mask52);
+    x.limb[1] = _mm512_and_si512(_mm512_or_si512(_mm512_srli_epi64(x0, 52), _mm512_slli_epi64(x1, 12)), mask52);
+    x.limb[2] = _mm512_and_si512(_mm512_or_si512(_mm512_srli_epi64(x1, 40), _mm512_slli_epi64(x2, 24)), mask52);
+    x.limb[3] = _mm512_and_si512(_mm512_or_si512(_mm512_srli_epi64(x2, 28), _mm512_slli_epi64(x3, 36)), mask52);
+    x.limb[4] = _mm512_srli_epi64(x3, 16);
+}
+
+/* loads the elements at p + idx[i], idx in limbs */
+TARGET_AVX512IFMA
+static inline void ifma_load(ifma_block &x, const mp_limb_t *p, const __m512i idx)
+{
+    const long long *q = (const long long*) p;
+    ifma_split(x,
+               _mm512_i64gather_epi64(idx, q, 8),
+               _mm512_i64gather_epi64(idx, q + 1, 8),
+               _mm512_i64gather_epi64(idx, q + 2, 8),
+               _mm512_i64gather_epi64(idx, q + 3, 8));
+}
+
+TARGET_AVX512IFMA
+static inline void ifma_broadcast(ifma_block &x, const mp_limb_t *p)
+{
+    ifma_split(x, _mm512_set1_epi64(p[0]), _mm512_set1_epi64(p[1]), _mm512_set1_epi64(p[2]), _mm512_set1_epi64(p[3]));
+}
+
+TARGET_AVX512IFMA
+static inline void ifma_store(mp_limb_t *p, const ifma_block &x, const __m512i idx)
+{
+    long long *q = (long long*) p;
+    _mm512_i64scatter_epi64(q, idx, _mm512_or_si512(x.limb[0], _mm512_slli_epi64(x.limb[1], 52)), 8);
+    _mm512_i64scatter_epi64(q + 1, idx, _mm512_or_si512(_mm512_srli_epi64(x.limb[1], 12), _mm512_slli_epi64(x.limb[2], 40)), 8);
+    _mm512_i64scatter_epi64(q + 2, idx, _mm512_or_si512(_mm512_srli_epi64(x.limb[2], 24), _mm512_slli_epi64(x.limb[3], 28)), 8);
+    _mm512_i64scatter_epi64(q + 3, idx, _mm512_or_si512(_mm512_srli_epi64(x.limb[3], 36), _mm512_slli_epi64(x.limb[4], 16)), 8);
+}
+
+TARGET_AVX512IFMA
+static inline void ifma_mont_mul(ifma_block &r, const ifma_block &a, const ifma_block &b, const ifma_modulus &m)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i mask52 = _mm512_set1_epi64((1ull<<52)-1);
+    const __m512i mask48 = _mm512_set1_epi64((1ull<<48)-1);
+
+    __m512i z[10];
+    for (size_t k = 0; k < 10; ++k)
+    {
+        z[k] = zero;
+    }
+
+    for (size_t i = 0; i < 5; ++i)
+    {
+        for (size_t j = 0; j < 5; ++j)
+        {
+            z[i+j] = _mm512_madd52lo_epu64(z[i+j], a.limb[i], b.limb[j]);
+            z[i+j+1] = _mm512_madd52hi_epu64(z[i+j+1], a.limb[i], b.limb[j]);
+        }
+    }
+
+    for (size_t i = 0; i < 5; ++i)
+    {
+        __m512i u = _mm512_madd52lo_epu64(zero, z[i], m.inv);
+        if (i == 4)
+        {
+            u = _mm512_and_si512(u, mask48);
+        }
+        for (size_t j = 0; j < 5; ++j)
+        {
+            z[i+j] = _mm512_madd52lo_epu64(z[i+j], u, m.p.limb[j]);
+            z[i+j+1] = _mm512_madd52hi_epu64(z[i+j+1], u, m.p.limb[j]);
+        }
+        if (i < 4)
+        {
+            z[i+1] = _mm512_add_epi64(z[i+1], _mm512_srli_epi64(z[i], 52));
+        }
+    }
+
+    /* the product is now z[4..9] >> 48 */
+    for (size_t k = 4; k < 9; ++k)
+    {
+        z[k+1] = _mm512_add_epi64(z[k+1], _mm512_srli_epi64(z[k], 52));
+        z[k] = _mm512_and_si512(z[k], mask52);
+    }
+    for (size_t k = 0; k < 5; ++k)
+    {
+        r.limb[k] = _mm512_and_si512(_mm512_or_si512(_mm512_srli_epi64(z[k+4], 48),
+                                                     _mm512_slli_epi64(z[k+5], 4)), mask52);
+    }
+
+    __m512i d[5], borrow = zero;
+    for (size_t k = 0; k < 5; ++k)
+    {
+        const __m512i t = _mm512_sub_epi64(_mm512_sub_epi64(r.limb[k], m.p.limb[k]), borrow);
+        borrow = _mm512_srli_epi64(t, 63);
+        d[k] = _mm512_and_si512(t, mask52);
+    }
+    const __mmask8 keep = _mm512_test_epi64_mask(borrow, borrow);
+    for (size_t k = 0; k < 5; ++k)
+    {
+        r.limb[k] = _mm512_mask_blend_epi64(keep, d[k], r.limb[k]);
+    }
+}
+
+TARGET_AVX512IFMA
+static void fp4_vector_mul_avx512ifma(mp_limb_t *out, const mp_limb_t *a, const mp_limb_t *b, const size_t b_stride,
+                                      const size_t count, const fp4_vector_modulus &p)
+{
+    const size_t lanes = 8;
+
+    ifma_modulus m;
+    ifma_split(m.p, _mm512_set1_epi64(p.p[0]), _mm512_set1_epi64(p.p[1]),
+               _mm512_set1_epi64(p.p[2]), _mm512_set1_epi64(p.p[3]));
+    m.inv = _mm512_set1_epi64(p.inv & ((1ull<<52)-1));
+
+    const __m512i a_idx = _mm512_set_epi64(28, 24, 20, 16, 12, 8, 4, 0);
+    const long long s = 4 * b_stride;
+    const __m512i b_idx = _mm512_set_epi64(7*s, 6*s, 5*s, 4*s, 3*s, 2*s, s, 0);
+
+    ifma_block x, y;
+    if (b_stride == 0)
+    {
+        ifma_broadcast(y, b);
+    }
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        ifma_load(x, a + 4*i, a_idx);
+        if (b_stride != 0)
+        {
+            ifma_load(y, b + 4*i*b_stride, b_idx);
+        }
+        ifma_mont_mul(x, x, y, m);
+        ifma_store(out + 4*i, x, a_idx);
+    }
+
+    if (i < count)
+    {
+        /* the last partial block is padded with zeros */
+        mp_limb_t ta[4*lanes] = {0}, tb[4*lanes] = {0};
+        for (size_t k = 0; k < count - i; ++k)
+        {
+            std::memcpy(ta + 4*k, a + 4*(i+k), 4*sizeof(mp_limb_t));
+            std::memcpy(tb + 4*k, b + 4*(i+k)*b_stride, 4*sizeof(mp_limb_t));
+        }
+        ifma_load(x, ta, a_idx);
+        if (b_stride != 0)
+        {
+            ifma_load(y, tb, a_idx);
+        }
+        ifma_mont_mul(x, x, y, m);
+        ifma_store(ta, x, a_idx);
+        std::memcpy(out + 4*i, ta, 4*(count - i)*sizeof(mp_limb_t));
+    }
+}
+
+/* four elements, in eight 32-bit limbs: limb j of element i is lane i of limb[j] */
+struct avx2_block {
+    __m256i limb[8];
+};
+
+struct avx2_modulus {
+    __m256i p[8];
+    __m256i inv;
+};
+
+/* transposes the 4x4 matrix of 64-bit words in r */
+TARGET_AVX2
+static inline void avx2_transpose(__m256i r[4])
+{
+    const __m256i t0 = _mm256_unpacklo_epi64(r[0], r[1]);
+    const __m256i t1 = _mm256_unpackhi_epi64(r[0], r[1]);
+    const __m256i t2 = _mm256_unpacklo_epi64(r[2], r[3]);
+    const __m256i t3 = _mm256_unpackhi_epi64(r[2], r[3]);
+    r[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+    r[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+    r[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+    r[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+TARGET_AVX2
+static inline void avx2_split(avx2_block &x, const __m256i w[4])
+{
+    const __m256i mask32 = _mm256_set1_epi64x(0xffffffffll);
+    for (size_t j = 0; j < 4; ++j)
+    {
+        x.limb[2*j] = _mm256_and_si256(w[j], mask32);
+        x.limb[2*j+1] = _mm256_srli_epi64(w[j], 32);
+    }
+}
+
+/* loads the elements at p + i*stride, stride in limbs */
+TARGET_AVX2
+static inline void avx2_load(avx2_block &x, const mp_limb_t *p, const size_t stride)
+{
+    __m256i w[4];
+    for (size_t i = 0; i < 4; ++i)
+    {
+        w[i] = _mm256_loadu_si256((const __m256i*) (p + i*stride));
+    }
+    avx2_transpose(w);
+    avx2_split(x, w);
+}
+
+TARGET_AVX2
+static inline void avx2_broadcast(avx2_block &x, const mp_limb_t *p)
+{
+    __m256i w[4];
+    for (size_t j = 0; j < 4; ++j)
+    {
+        w[j] = _mm256_set1_epi64x(p[j]);
+    }
+    avx2_split(x, w);
+}
+
+TARGET_AVX2
+static inline void avx2_store(mp_limb_t *p, const avx2_block &x)
+{
+    __m256i w[4];
+    for (size_t j = 0; j < 4; ++j)
+    {
+        w[j] = _mm256_or_si256(x.limb[2*j], _mm256_slli_epi64(x.limb[2*j+1], 32));
+    }
+    avx2_transpose(w);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        _mm256_storeu_si256((__m256i*) (p + 4*i), w[i]);
+    }
+}
+
+TARGET_AVX2
+static inline void avx2_mont_mul(avx2_block &r, const avx2_block &a, const avx2_block &b, const avx2_modulus &m)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mask32 = _mm256_set1_epi64x(0xffffffffll);
+
+    __m256i z[16];
+    for (size_t k = 0; k < 16; ++k)
+    {
+        z[k] = zero;
+    }
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        for (size_t j = 0; j < 8; ++j)
+        {
+            const __m256i t = _mm256_mul_epu32(a.limb[i], b.limb[j]);
+            z[i+j] = _mm256_add_epi64(z[i+j], _mm256_and_si256(t, mask32));
+            z[i+j+1] = _mm256_add_epi64(z[i+j+1], _mm256_srli_epi64(t, 32));
+        }
+    }
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        /* only the low 32 bits of u are read below */
+        const __m256i u = _mm256_mul_epu32(z[i], m.inv);
+        for (size_t j = 0; j < 8; ++j)
+        {
+            const __m256i t = _mm256_mul_epu32(u, m.p[j]);
+            z[i+j] = _mm256_add_epi64(z[i+j], _mm256_and_si256(t, mask32));
+            z[i+j+1] = _mm256_add_epi64(z[i+j+1], _mm256_srli_epi64(t, 32));
+        }
+        z[i+1] = _mm256_add_epi64(z[i+1], _mm256_srli_epi64(z[i], 32));
+    }
+
+    /* the product is now z[8..15]; it is below 2p < 2^255 */
+    for (size_t k = 8; k < 15; ++k)
+    {
+        z[k+1] = _mm256_add_epi64(z[k+1], _mm256_srli_epi64(z[k], 32));
+        r.limb[k-8] = _mm256_and_si256(z[k], mask32);
+    }
+    r.limb[7] = z[15];
+
+    __m256i d[8], borrow = zero;
+    for (size_t k = 0; k < 8; ++k)
+    {
+        const __m256i t = _mm256_sub_epi64(_mm256_sub_epi64(r.limb[k], m.p[k]), borrow);
+        borrow = _mm256_srli_epi64(t, 63);
+        d[k] = _mm256_and_si256(t, mask32);
+    }
+    const __m256i keep = _mm256_sub_epi64(zero, borrow);
+    for (size_t k = 0; k < 8; ++k)
+    {
+        r.limb[k] = _mm256_blendv_epi8(d[k], r.limb[k], keep);
+    }
+}
+
+TARGET_AVX2
+static void fp4_vector_mul_avx2(mp_limb_t *out, const mp_limb_t *a, const mp_limb_t *b, const size_t b_stride,
+                                const size_t count, const fp4_vector_modulus &p)
+{
+    const size_t lanes = 4;
+
+    avx2_modulus m;
+    const __m256i mask32 = _mm256_set1_epi64x(0xffffffffll);
+    for (size_t j = 0; j < 4; ++j)
+    {
+        m.p[2*j] = _mm256_set1_epi64x(p.p[j] & 0xffffffff);
+        m.p[2*j+1] = _mm256_set1_epi64x(p.p[j] >> 32);
+    }
+    m.inv = _mm256_and_si256(_mm256_set1_epi64x(p.inv), mask32);
+
+    avx2_block x, y;
+    if (b_stride == 0)
+    {
+        avx2_broadcast(y, b);
+    }
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes)
+    {
+        avx2_load(x, a + 4*i, 4);
+        if (b_stride != 0)
+        {
+            avx2_load(y, b + 4*i*b_stride, 4*b_stride);
+        }
+        avx2_mont_mul(x, x, y, m);
+        avx2_store(out + 4*i, x);
+    }
+
+    if (i < count)
+    {
+        /* the last partial block is padded with zeros */
+        mp_limb_t ta[4*lanes] = {0}, tb[4*lanes] = {0};
+        for (size_t k = 0; k < count - i; ++k)
+        {
+            std::memcpy(ta + 4*k, a + 4*(i+k), 4*sizeof(mp_limb_t));
+            std::memcpy(tb + 4*k, b + 4*(i+k)*b_stride, 4*sizeof(mp_limb_t));
+        }
+        avx2_load(x, ta, 4);
+        if (b_stride != 0)
+        {
+            avx2_load(y, tb, 4);
+        }
+        avx2_mont_mul(x, x, y, m);
+        avx2_store(ta, x);
+        std::memcpy(out + 4*i, ta, 4*(count - i)*sizeof(mp_limb_t));
+    }
+}
+
+#endif
+
+size_t fp4_vector_lanes()
+{
+#if defined(__x86_64__)
+    if (cpu_has_avx512ifma)
+    {
+        return 8;
+    }
+    /* the AVX2 kernel is only about as fast as the scalar code without MULX,
+       and slower than the scalar code with it */
+    if (cpu_has_avx2 && !cpu_has_mulx_adx)
+    {
+        return 4;
+    }
+#endif
+    return 0;
+}
+
+void fp4_vector_mul(mp_limb_t *out, const mp_limb_t *a, const mp_limb_t *b, const size_t b_stride,
+                    const size_t count, const fp4_vector_modulus &p)
+{
+#if defined(__x86_64__)
+    if (cpu_has_avx512ifma)
+    {
+        fp4_vector_mul_avx512ifma(out, a, b, b_stride, count, p);
+        return;
+    }
+    if (cpu_has_avx2)
+    {
+        fp4_vector_mul_avx2(out, a, b, b_stride, count, p);
+        return;
+    }
+#endif
+    assert(0);
+}
+
+} // libsnark
@@ -0,0 +1,55 @@
+/** @file
+ *****************************************************************************
+ Declaration of vectorized multiplication of arrays of elements of F[p], for
+ a prime p of four limbs.
+
+ The kernels transpose blocks of elements into structure-of-arrays form, with
+ limb j of all the elements of a block in one vector register, and multiply
+ all the elements of the block at once: eight elements of five 52-bit limbs
+ with AVX-512 IFMA, or else four elements of eight 32-bit limbs with AVX2.
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef FP_VECTOR_HPP_
+#define FP_VECTOR_HPP_
+
+#include <cstddef>
+
+#include <gmp.h>
+
+namespace libsnark {
+
+/**
+ * A prime p < 2^254 and its Montgomery constant -p^{-1} mod 2^64, as read by
+ * the vector kernels. Products are in the Montgomery form of Fp_model<4, p>,
+ * i.e. a * b * 2^{-256} mod p.
+ */
+class fp4_vector_modulus {
+public:
+    mp_limb_t p[4];
+    mp_limb_t inv;
+
+    fp4_vector_modulus(const mp_limb_t *p, const mp_limb_t inv);
+};
+
+/**
+ * The number of elements multiplied at once by fp4_vector_mul on this CPU,
+ * or 0 if no vector kernel is faster than the scalar multiplication.
+ */
+size_t fp4_vector_lanes();
+
+/**
+ * Sets out[i] to the Montgomery product of a[i] and b[i*b_stride], for
+ * i < count; each element is four consecutive limbs less than p. A b_stride
+ * of 0 multiplies all of a by b[0]. out may be equal to a, or to b if
+ * b_stride is 1, but must not overlap them otherwise.
+ */
+void fp4_vector_mul(mp_limb_t *out, const mp_limb_t *a, const mp_limb_t *b, const size_t b_stride,
+                    const size_t count, const fp4_vector_modulus &p);
+
+} // libsnark
+
+#endif // FP_VECTOR_HPP_
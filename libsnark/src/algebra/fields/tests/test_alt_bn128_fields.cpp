@@ -0,0 +1,285 @@
+/**
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+#include <cassert>
+#include <vector>
+
+#include "common/cpu_features.hpp"
+#include "algebra/curves/alt_bn128/alt_bn128_pp.hpp"
+#include "algebra/fields/field_utils.hpp"
+#include "algebra/exponentiation/exponentiation.hpp"
+
+using namespace libsnark;
+
+/* zero, one, -1, -2, the element whose Montgomery representation is p-1,
+   and random elements */
+template<typename FieldT>
+std::vector<FieldT> test_values(const size_t num_random)
+{
+    std::vector<FieldT> values = { FieldT::zero(), FieldT::one(), -FieldT::one(), -(FieldT::one() + FieldT::one()) };
+
+    FieldT largest;
+    largest.mont_repr = FieldT::mod;
+    mpn_sub_1(largest.mont_repr.data, largest.mont_repr.data, FieldT::num_limbs, 1);
+    values.emplace_back(largest);
+
+    for (size_t i = 0; i < num_random; ++i)
+    {
+        values.emplace_back(FieldT::random_element());
+    }
+    return values;
+}
+
+template<typename FieldT>
+bool is_reduced(const FieldT &a)
+{
+    return mpn_cmp(a.mont_repr.data, FieldT::mod.data, FieldT::num_limbs) < 0;
+}
+
+/* the MULX multiplication and squaring (MULX_4_BY_4_MONT_MUL,
+   MULX_4_MONT_SQR) against the generic ones */
+template<typename FieldT>
+void test_mulx_mont_mul()
+{
+    const bool has_mulx_adx = cpu_has_mulx_adx;
+    if (!has_mulx_adx)
+    {
+        return;
+    }
+
+    const std::vector<FieldT> values = test_values<FieldT>(100);
+    for (const FieldT &a : values)
+    {
+        for (const FieldT &b : values)
+        {
+            cpu_has_mulx_adx = true;
+            const FieldT mulx_product = a * b;
+            const FieldT mulx_square = a.squared();
+
+            cpu_has_mulx_adx = false;
+            const FieldT product = a * b;
+            const FieldT square = a.squared();
+
+            assert(mulx_product == product);
+            assert(mulx_square == square);
+            assert(is_reduced(mulx_product));
+            assert(is_reduced(mulx_square));
+        }
+    }
+
+    cpu_has_mulx_adx = has_mulx_adx;
+}
+
+/* batch_mul against element-wise products, for every stride and count the
+   vector kernels (fp4_vector_mul) handle differently, in place or not */
+template<typename FieldT>
+void test_batch_mul_once()
+{
+    const size_t max_count = 44;
+    const size_t max_stride = 3;
+
+    std::vector<FieldT> a = test_values<FieldT>(max_count);
+    std::vector<FieldT> b = test_values<FieldT>(max_count * max_stride);
+    /* (-1)^2, and the largest representation squared */
+    b[2] = a[2];
+    b[4] = a[4];
+
+    for (const size_t stride : { 0, 1, 3 })
+    {
+        for (size_t count = 0; count <= max_count; ++count)
+        {
+            std::vector<FieldT> expected(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                expected[i] = a[i] * b[i*stride];
+            }
+
+            std::vector<FieldT> out(count);
+            batch_mul(out.data(), a.data(), b.data(), stride, count);
+            assert(out == expected);
+
+            std::vector<FieldT> in_place(a.begin(), a.begin() + count);
+            batch_mul(in_place.data(), in_place.data(), b.data(), stride, count);
+            assert(in_place == expected);
+
+            if (stride == 1)
+            {
+                in_place.assign(b.begin(), b.begin() + count);
+                batch_mul(in_place.data(), a.data(), in_place.data(), stride, count);
+                assert(in_place == expected);
+            }
+        }
+    }
+
+    FieldT square;
+    batch_mul(&square, &a[2], &a[2], 0, 1);
+    assert(square == FieldT::one());
+}
+
+/* the AVX-512 IFMA, AVX2 and scalar paths of batch_mul, in turn, as far as
+   the CPU supports them */
+template<typename FieldT>
+void test_batch_mul()
+{
+    const bool has_avx512ifma = cpu_has_avx512ifma;
+    const bool has_avx2 = cpu_has_avx2;
+    const bool has_mulx_adx = cpu_has_mulx_adx;
+
+    test_batch_mul_once<FieldT>();
+
+    cpu_has_avx512ifma = false;
+    /* the AVX2 kernel is only used without MULX */
+    cpu_has_mulx_adx = false;
+    test_batch_mul_once<FieldT>();
+
+    cpu_has_avx2 = false;
+    test_batch_mul_once<FieldT>();
+
+    cpu_has_avx512ifma = has_avx512ifma;
+    cpu_has_avx2 = has_avx2;
+    cpu_has_mulx_adx = has_mulx_adx;
+}
+
+/* the double-width products and sums of Fp_dbl_model, with and without MULX */
+void test_Fp_dbl()
+{
+    typedef alt_bn128_Fq FieldT;
+    typedef Fp_dbl_model<alt_bn128_q_limbs, alt_bn128_modulus_q> FieldT_dbl;
+
+    const bool has_mulx_adx = cpu_has_mulx_adx;
+    const std::vector<FieldT> values = test_values<FieldT>(20);
+    for (const bool mulx_adx : { false, has_mulx_adx })
+    {
+        cpu_has_mulx_adx = mulx_adx;
+        for (const FieldT &a : values)
+        {
+            for (const FieldT &b : values)
+            {
+                const FieldT_dbl ab(a, b), bb(b, b);
+                assert(ab.reduce() == a * b);
+                assert(is_reduced(ab.reduce()));
+                assert((ab + bb).reduce() == a * b + b * b);
+                assert((ab - bb).reduce() == a * b - b * b);
+                assert((bb - ab).reduce() == b * b - a * b);
+                assert(ab.mul_by_ulong(9).reduce() == FieldT(9) * a * b);
+            }
+        }
+    }
+    cpu_has_mulx_adx = has_mulx_adx;
+}
+
+/* sets the flags that select the lazy-reduction formulas of the extension
+   fields, as alt_bn128_pp::init_public_params does, or clears them */
+void set_lazy_reduction(const bool lazy)
+{
+    alt_bn128_Fq2::non_residue_is_minus_one = lazy;
+    alt_bn128_Fq6::non_residue_small_c0 = (lazy ? 9 : 0);
+}
+
+/* Fp2 products and squares, mul_by_024 (mul_by_024_lazy) and
+   cyclotomic_squared with the lazy-reduction formulas against the generic
+   ones, and the generic ones against their definitions */
+void test_lazy_reduction()
+{
+    const alt_bn128_Fq non_residue = alt_bn128_Fq2::non_residue;
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        const alt_bn128_Fq2 x = alt_bn128_Fq2::random_element();
+        const alt_bn128_Fq2 y = (i == 0 ? -alt_bn128_Fq2::one() : alt_bn128_Fq2::random_element());
+
+        set_lazy_reduction(true);
+        const alt_bn128_Fq2 lazy_product = x * y;
+        const alt_bn128_Fq2 lazy_square = x.squared();
+
+        set_lazy_reduction(false);
+        assert(lazy_product == x * y);
+        assert(lazy_square == x.squared());
+        assert(x * y == alt_bn128_Fq2(x.c0 * y.c0 + non_residue * x.c1 * y.c1,
+                                      x.c0 * y.c1 + x.c1 * y.c0));
+    }
+
+    set_lazy_reduction(true);
+    for (size_t i = 0; i < 10; ++i)
+    {
+        const alt_bn128_Fq12 a = alt_bn128_Fq12::random_element();
+        const alt_bn128_Fq2 ell_0 = alt_bn128_Fq2::random_element();
+        const alt_bn128_Fq2 ell_VW = alt_bn128_Fq2::random_element();
+        const alt_bn128_Fq2 ell_VV = alt_bn128_Fq2::random_element();
+        /* beta = a^((q^6-1)*(q^2+1)) is in the cyclotomic subgroup */
+        const alt_bn128_Fq12 a_unitary = a.Frobenius_map(6) * a.inverse();
+        const alt_bn128_Fq12 beta = a_unitary.Frobenius_map(2) * a_unitary;
+
+        const alt_bn128_Fq12 lazy_024 = a.mul_by_024(ell_0, ell_VW, ell_VV);
+        const alt_bn128_Fq12 lazy_cyclotomic = beta.cyclotomic_squared();
+
+        set_lazy_reduction(false);
+        const alt_bn128_Fq12 sparse(alt_bn128_Fq6(ell_0, alt_bn128_Fq2::zero(), ell_VV),
+                                    alt_bn128_Fq6(alt_bn128_Fq2::zero(), ell_VW, alt_bn128_Fq2::zero()));
+        assert(a.mul_by_024(ell_0, ell_VW, ell_VV) == a * sparse);
+        assert(lazy_024 == a * sparse);
+        assert(beta.cyclotomic_squared() == beta.squared());
+        assert(lazy_cyclotomic == beta.squared());
+        set_lazy_reduction(true);
+    }
+}
+
+/* power_fixed_window against power, and the square roots of squares of the
+   fixed-sequence paths (Fq, whose modulus is 3 mod 4, and sqrt_complex)
+   and of Tonelli-Shanks (Fr), including zero and the Fq2 elements with
+   c1 = 0, whether c0 is a square in Fq or not */
+void test_sqrt()
+{
+    for (const alt_bn128_Fq &a : test_values<alt_bn128_Fq>(20))
+    {
+        for (const size_t window_size : { 1, 4, 5 })
+        {
+            assert(power_fixed_window(a, alt_bn128_Fq::t_minus_1_over_2, window_size) == (a ^ alt_bn128_Fq::t_minus_1_over_2));
+        }
+
+        const alt_bn128_Fq square = a.squared();
+        const alt_bn128_Fq root = square.sqrt();
+        assert(root.squared() == square);
+    }
+
+    for (const alt_bn128_Fr &a : test_values<alt_bn128_Fr>(20))
+    {
+        const alt_bn128_Fr square = a.squared();
+        assert(square.sqrt().squared() == square);
+    }
+
+    std::vector<alt_bn128_Fq2> values = { alt_bn128_Fq2::zero(), alt_bn128_Fq2::one(), -alt_bn128_Fq2::one() };
+    for (const alt_bn128_Fq &c0 : test_values<alt_bn128_Fq>(20))
+    {
+        values.emplace_back(alt_bn128_Fq2(c0, alt_bn128_Fq::zero()));
+        values.emplace_back(alt_bn128_Fq2(alt_bn128_Fq::zero(), c0));
+        values.emplace_back(alt_bn128_Fq2::random_element());
+    }
+    for (const alt_bn128_Fq2 &a : values)
+    {
+        const alt_bn128_Fq2 square = a.squared();
+        assert(square.sqrt().squared() == square);
+        /* -1 is not a square in Fq, so c0 + 0*u is a square in Fq2 either way */
+        assert(alt_bn128_Fq2(a.c0, alt_bn128_Fq::zero()).sqrt().squared() == alt_bn128_Fq2(a.c0, alt_bn128_Fq::zero()));
+    }
+}
+
+int main(void)
+{
+    alt_bn128_pp::init_public_params();
+
+    test_mulx_mont_mul<alt_bn128_Fq>();
+    test_mulx_mont_mul<alt_bn128_Fr>();
+
+    test_batch_mul<alt_bn128_Fq>();
+    test_batch_mul<alt_bn128_Fr>();
+
+    test_Fp_dbl();
+    test_lazy_reduction();
+    test_sqrt();
+
+    return 0;
+}
@@ -14,6 +14,7 @@
 #ifndef KNOWLEDGE_COMMITMENT_HPP_
 #define KNOWLEDGE_COMMITMENT_HPP_
 
+#include "algebra/curves/curve_utils.hpp"
 #include "algebra/fields/fp.hpp"
 #include "common/data_structures/sparse_vector.hpp"
 
@@ -44,6 +45,8 @@ struct knowledge_commitment {
     knowledge_commitment<T1,T2>& operator=(const knowledge_commitment<T1,T2> &other) = default;
     knowledge_commitment<T1,T2>& operator=(knowledge_commitment<T1,T2> &&other) = default;
     knowledge_commitment<T1,T2> operator+(const knowledge_commitment<T1, T2> &other) const;
+    knowledge_commitment<T1,T2> operator-() const;
+    knowledge_commitment<T1,T2> dbl() const;
 
     bool is_zero() const;
     bool operator==(const knowledge_commitment<T1,T2> &other) const;
@@ -69,6 +72,28 @@ std::ostream& operator<<(std::ostream& out, const knowledge_commitment<T1,T2> &k
 template<typename T1,typename T2>
 std::istream& operator>>(std::istream& in, knowledge_commitment<T1,T2> &kc);
 
+/**
+ * If both T1 and T2 have a GLV endomorphism, with the same lambda, then so do
+ * knowledge commitments: the endomorphism is applied componentwise.
+ */
+template<typename T1, typename T2>
+class glv_endomorphism<knowledge_commitment<T1,T2> > {
+public:
+    static const bool available = glv_endomorphism<T1>::available && glv_endomorphism<T2>::available;
+
+    static knowledge_commitment<T1,T2> apply(const knowledge_commitment<T1,T2> &P)
+    {
+        return knowledge_commitment<T1,T2>(glv_endomorphism<T1>::apply(P.g),
+                                           glv_endomorphism<T2>::apply(P.h));
+    }
+
+    template<mp_size_t n>
+    static void decompose(const bigint<n> &k, bigint<n> &k1, bool &k1_neg, bigint<n> &k2, bool &k2_neg)
+    {
+        glv_endomorphism<T1>::decompose(k, k1, k1_neg, k2, k2_neg);
+    }
+};
+
 /******************** Knowledge commitment vector ****************************/
 
 /**
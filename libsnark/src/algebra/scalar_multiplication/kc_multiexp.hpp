@@ -32,7 +32,7 @@ knowledge_commitment<T1, T2> kc_multi_exp_with_mixed_addition(const knowledge_co
                                                                 typename std::vector<FieldT>::const_iterator scalar_start,
                                                                 typename std::vector<FieldT>::const_iterator scalar_end,
                                                                 const size_t chunks,
-                                                                const bool use_multiexp=false);
+                                                                const multi_exp_method method=multi_exp_method_naive);
 
 template<typename T1, typename T2>
 void kc_batch_to_special(std::vector<knowledge_commitment<T1, T2> > &vec);
@@ -25,7 +25,7 @@ knowledge_commitment<T1, T2> kc_multi_exp_with_mixed_addition(const knowledge_co
                                                                 typename std::vector<FieldT>::const_iterator scalar_start,
                                                                 typename std::vector<FieldT>::const_iterator scalar_end,
                                                                 const size_t chunks,
-                                                                const bool use_multiexp)
+                                                                const multi_exp_method method)
 {
     enter_block("Process scalar vector");
     auto index_it = std::lower_bound(vec.indices.begin(), vec.indices.end(), min_idx);
@@ -86,7 +86,26 @@ knowledge_commitment<T1, T2> kc_multi_exp_with_mixed_addition(const knowledge_co
     //print_indent(); printf("* Elements of w remaining: %zu (%0.2f%%)\n", num_other, 100.*num_other/(num_skip+num_add+num_other));
     leave_block("Process scalar vector");
 
-    return acc + multi_exp<knowledge_commitment<T1, T2>, FieldT>(g.begin(), g.end(), p.begin(), p.end(), chunks, use_multiexp);
+    if (method == multi_exp_method_BDLO12 && batch_affine_addition<T1>::available && batch_affine_addition<T2>::available)
+    {
+        /* handle the two components separately, so that both can use batch-affine bucket accumulation */
+        std::vector<T1> g_g;
+        std::vector<T2> g_h;
+        g_g.reserve(g.size());
+        g_h.reserve(g.size());
+        for (const knowledge_commitment<T1, T2> &el : g)
+        {
+            g_g.emplace_back(el.g);
+            g_h.emplace_back(el.h);
+        }
+        g.clear();
+        g.shrink_to_fit();
+
+        return acc + knowledge_commitment<T1, T2>(multi_exp_special<T1, FieldT>(g_g.begin(), g_g.end(), p.begin(), p.end(), chunks, method),
+                                                  multi_exp_special<T2, FieldT>(g_h.begin(), g_h.end(), p.begin(), p.end(), chunks, method));
+    }
+
+    return acc + multi_exp<knowledge_commitment<T1, T2>, FieldT>(g.begin(), g.end(), p.begin(), p.end(), chunks, method);
 }
 
 template<typename T1, typename T2>
@@ -94,68 +113,47 @@ void kc_batch_to_special(std::vector<knowledge_commitment<T1, T2> > &vec)
 {
     enter_block("Batch-convert knowledge-commitments to special form");
 
-    std::vector<T1> g_vec;
-    g_vec.reserve(vec.size());
-
+    std::vector<T1> g_vec(vec.size());
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
     for (size_t i = 0; i < vec.size(); ++i)
     {
-        if (!vec[i].g.is_zero())
-        {
-            g_vec.emplace_back(vec[i].g);
-        }
+        g_vec[i] = vec[i].g;
     }
 
     batch_to_special_all_non_zeros<T1>(g_vec);
-    auto g_it = g_vec.begin();
-    T1 T1_zero_special = T1::zero();
-    T1_zero_special.to_special();
 
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
     for (size_t i = 0; i < vec.size(); ++i)
     {
-        if (!vec[i].g.is_zero())
-        {
-            vec[i].g = *g_it;
-            ++g_it;
-        }
-        else
-        {
-            vec[i].g = T1_zero_special;
-        }
+        vec[i].g = g_vec[i];
     }
 
     g_vec.clear();
+    g_vec.shrink_to_fit();
 
-    std::vector<T2> h_vec;
-    h_vec.reserve(vec.size());
-
+    std::vector<T2> h_vec(vec.size());
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
     for (size_t i = 0; i < vec.size(); ++i)
     {
-        if (!vec[i].h.is_zero())
-        {
-            h_vec.emplace_back(vec[i].h);
-        }
+        h_vec[i] = vec[i].h;
     }
 
     batch_to_special_all_non_zeros<T2>(h_vec);
-    auto h_it = h_vec.begin();
-    T2 T2_zero_special = T2::zero();
-    T2_zero_special.to_special();
 
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
     for (size_t i = 0; i < vec.size(); ++i)
     {
-        if (!vec[i].h.is_zero())
-        {
-            vec[i].h = *h_it;
-            ++h_it;
-        }
-        else
-        {
-            vec[i].h = T2_zero_special;
-        }
+        vec[i].h = h_vec[i];
     }
 
-    g_vec.clear();
-
     leave_block("Batch-convert knowledge-commitments to special form");
 }
 
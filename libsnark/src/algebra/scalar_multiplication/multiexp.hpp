@@ -14,6 +14,37 @@
 
 namespace libsnark {
 
+/**
+ * Methods available for the variable-base multi-exponentiation routines below.
+ */
+enum multi_exp_method {
+    /**
+     * Individually multiply each base by the corresponding scalar (using
+     * wNAF exponentiation) and add up the results.
+     */
+    multi_exp_method_naive,
+    /**
+     * Like multi_exp_method_naive, but use the operator '*' of the group
+     * for each individual exponentiation.
+     */
+    multi_exp_method_naive_plain,
+    /**
+     * A variant of the Bos-Coster algorithm [1], with implementation
+     * suggestions from [2].
+     *
+     * [1] = Bos and Coster, "Addition chain heuristics", CRYPTO '89
+     * [2] = Bernstein, Duif, Lange, Schwabe, and Yang, "High-speed high-security signatures", CHES '11
+     */
+    multi_exp_method_bos_coster,
+    /**
+     * The bucket method of Pippenger, as described in Section 4 of [3].
+     * The window size is chosen based on the number of terms.
+     *
+     * [3] = Bernstein, Doumen, Lange, and Oosterwijk, "Faster batch forgery identification", INDOCRYPT '12
+     */
+    multi_exp_method_BDLO12
+};
+
 /**
  * Naive multi-exponentiation individually multiplies each base by the
  * corresponding scalar and adds up the results.
@@ -31,11 +62,12 @@ T naive_plain_exp(typename std::vector<T>::const_iterator vec_start,
                   typename std::vector<FieldT>::const_iterator scalar_end);
 
 /**
- * Naive multi-exponentiation uses a variant of the Bos-Coster algorithm [1],
- * and implementation suggestions from [2].
+ * Multi-exponentiation computes sum_i scalar_i * vec_i using the given
+ * method (see multi_exp_method above).
  *
- * [1] = Bos and Coster, "Addition chain heuristics", CRYPTO '89
- * [2] = Bernstein, Duif, Lange, Schwabe, and Yang, "High-speed high-security signatures", CHES '11
+ * If chunks > 1, the work is split into several small tasks per chunk
+ * (for BDLO12, by window and by range of terms), which are handed out
+ * dynamically to the available threads.
  */
 template<typename T, typename FieldT>
 T multi_exp(typename std::vector<T>::const_iterator vec_start,
@@ -43,11 +75,15 @@ T multi_exp(typename std::vector<T>::const_iterator vec_start,
             typename std::vector<FieldT>::const_iterator scalar_start,
             typename std::vector<FieldT>::const_iterator scalar_end,
             const size_t chunks,
-            const bool use_multiexp=false);
+            const multi_exp_method method=multi_exp_method_naive);
 
 
 /**
  * A variant of multi_exp that takes advantage of the method mixed_add (instead of the operator '+').
+ *
+ * With multi_exp_method_BDLO12, if T supports it (see batch_affine_addition) and all bases are
+ * in special form, the buckets are accumulated in affine coordinates, with one field inversion
+ * shared by each batch of additions.
  */
 template<typename T, typename FieldT>
 T multi_exp_with_mixed_addition(typename std::vector<T>::const_iterator vec_start,
@@ -55,7 +91,7 @@ T multi_exp_with_mixed_addition(typename std::vector<T>::const_iterator vec_star
                                   typename std::vector<FieldT>::const_iterator scalar_start,
                                   typename std::vector<FieldT>::const_iterator scalar_end,
                                   const size_t chunks,
-                                  const bool use_multiexp);
+                                  const multi_exp_method method);
 
 /**
  * A window table stores window sizes for different instance sizes for fixed-base multi-scalar multiplications.
@@ -96,7 +132,11 @@ std::vector<T> batch_exp_with_coeff(const size_t scalar_size,
                                     const FieldT &coeff,
                                     const std::vector<FieldT> &v);
 
-// defined in every curve
+/**
+ * Converts vec to special form with one batched inversion; defined in every
+ * curve. Despite the name, zero elements are accepted and converted to the
+ * special form of zero.
+ */
 template<typename T>
 void batch_to_special_all_non_zeros(std::vector<T> &vec);
 
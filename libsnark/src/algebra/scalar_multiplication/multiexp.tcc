@@ -18,14 +18,27 @@
 
 #include <algorithm>
 #include <cassert>
+#include <string>
 #include <type_traits>
+#ifdef MULTICORE
+#include <omp.h>
+#endif
 
 #include "common/profiling.hpp"
 #include "common/utils.hpp"
+#include "algebra/curves/curve_utils.hpp"
+#include "algebra/fields/field_utils.hpp"
 #include "algebra/scalar_multiplication/wnaf.hpp"
 
 namespace libsnark {
 
+/*
+  Number of tasks per thread that the parallel multi-exponentiation routines
+  split their work into. Tasks are scheduled dynamically, so a few tasks per
+  thread suffice to keep all threads busy until the end.
+*/
+const size_t multi_exp_tasks_per_thread = 4;
+
 template<mp_size_t n>
 class ordered_exponent {
 // to use std::push_heap and friends later
@@ -41,7 +54,7 @@ public:
         if (n == 3)
         {
             long res;
-            __asm__
+            __asm__ volatile
                 ("// check for overflow           \n\t"
                  "mov $0, %[res]                  \n\t"
                  ADD_CMP(16)
@@ -53,13 +66,13 @@ public:
                  "done%=:                         \n\t"
                  : [res] "=&r" (res)
                  : [A] "r" (other.r.data), [mod] "r" (this->r.data)
-                 : "cc", "%rax");
+                 : "cc", "memory", "%rax");
             return res;
         }
         else if (n == 4)
         {
             long res;
-            __asm__
+            __asm__ volatile
                 ("// check for overflow           \n\t"
                  "mov $0, %[res]                  \n\t"
                  ADD_CMP(24)
@@ -72,13 +85,13 @@ public:
                  "done%=:                         \n\t"
                  : [res] "=&r" (res)
                  : [A] "r" (other.r.data), [mod] "r" (this->r.data)
-                 : "cc", "%rax");
+                 : "cc", "memory", "%rax");
             return res;
         }
         else if (n == 5)
         {
             long res;
-            __asm__
+            __asm__ volatile
                 ("// check for overflow           \n\t"
                  "mov $0, %[res]                  \n\t"
                  ADD_CMP(32)
@@ -92,7 +105,7 @@ public:
                  "done%=:                         \n\t"
                  : [res] "=&r" (res)
                  : [A] "r" (other.r.data), [mod] "r" (this->r.data)
-                 : "cc", "%rax");
+                 : "cc", "memory", "%rax");
             return res;
         }
         else
@@ -266,54 +279,710 @@ T multi_exp_inner(typename std::vector<T>::const_iterator vec_start,
     return opt_result;
 }
 
+/*
+  Choose the window size c for the bucket method, by minimizing the
+  estimated number of group additions: for each of the ceil(b/c) windows,
+  one addition per term to put it into a bucket, plus two additions per
+  bucket to combine the 2^c - 1 buckets with a running sum.
+*/
+inline size_t get_multi_exp_BDLO12_window_size(const size_t num_terms, const size_t scalar_bits)
+{
+    size_t best_c = 1;
+    size_t best_cost = (size_t)-1;
+
+    for (size_t c = 1; c <= 20; ++c)
+    {
+        const size_t cost = ((scalar_bits + c - 1) / c) * (num_terms + (2ul << c));
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best_c = c;
+        }
+    }
+
+    return best_c;
+}
+
+/*
+  Extract bits [offset, offset+c) of the given bigint.
+*/
+template<mp_size_t n>
+size_t get_multi_exp_BDLO12_digit(const bigint<n> &scalar, const size_t offset, const size_t c)
+{
+    const size_t limb = offset / GMP_NUMB_BITS;
+    const size_t bit = offset % GMP_NUMB_BITS;
+
+    if (limb >= (size_t)n)
+    {
+        return 0;
+    }
+
+    mp_limb_t digit = scalar.data[limb] >> bit;
+    if (bit + c > GMP_NUMB_BITS && limb + 1 < (size_t)n)
+    {
+        digit |= scalar.data[limb + 1] << (GMP_NUMB_BITS - bit);
+    }
+
+    return digit & ((1ul << c) - 1);
+}
+
+/*
+  A scalar k of the bucket method, split using the GLV endomorphism of the
+  group (see glv_endomorphism) as k = k1 + k2 * lambda: the term k * P is
+  then processed as the two terms of half the length k1 * P and k2 * phi(P).
+*/
+template<mp_size_t n>
+struct multi_exp_glv_scalar {
+    bigint<n> k1, k2;
+    bool k1_neg, k2_neg;
+
+    size_t num_bits() const { return std::max(k1.num_bits(), k2.num_bits()); }
+};
+
+/*
+  The representation of the scalars used by the bucket method for group T:
+  split scalars for groups with a GLV endomorphism, and plain bigints otherwise.
+*/
+template<typename T, mp_size_t n>
+struct multi_exp_BDLO12_scalar {
+    static const bool use_glv = glv_endomorphism<T>::available;
+    typedef typename std::conditional<use_glv, multi_exp_glv_scalar<n>, bigint<n> >::type type;
+    // number of bucket additions per term and window
+    static const size_t num_parts = (use_glv ? 2 : 1);
+};
+
+template<typename T, mp_size_t n>
+void multi_exp_BDLO12_convert(const bigint<n> &k, bigint<n> &res)
+{
+    res = k;
+}
+
+template<typename T, mp_size_t n>
+void multi_exp_BDLO12_convert(const bigint<n> &k, multi_exp_glv_scalar<n> &res)
+{
+    glv_endomorphism<T>::decompose(k, res.k1, res.k1_neg, res.k2, res.k2_neg);
+}
+
+/*
+  Call f(digit, P) for each nonzero c-bit digit (at the given offset) of the
+  given scalar, where P is the base that the digit multiplies: the base
+  itself for plain scalars, and +/-base and +/-phi(base) for split scalars.
+*/
+template<typename T, mp_size_t n, typename F>
+void multi_exp_BDLO12_for_each_digit(const T &base,
+                                     const bigint<n> &scalar,
+                                     const size_t offset,
+                                     const size_t c,
+                                     F f)
+{
+    const size_t digit = get_multi_exp_BDLO12_digit(scalar, offset, c);
+    if (digit != 0)
+    {
+        f(digit, base);
+    }
+}
+
+template<typename T, mp_size_t n, typename F>
+void multi_exp_BDLO12_for_each_digit(const T &base,
+                                     const multi_exp_glv_scalar<n> &scalar,
+                                     const size_t offset,
+                                     const size_t c,
+                                     F f)
+{
+    const size_t digit1 = get_multi_exp_BDLO12_digit(scalar.k1, offset, c);
+    if (digit1 != 0)
+    {
+        f(digit1, (scalar.k1_neg ? -base : base));
+    }
+
+    const size_t digit2 = get_multi_exp_BDLO12_digit(scalar.k2, offset, c);
+    if (digit2 != 0)
+    {
+        const T endo = glv_endomorphism<T>::apply(base);
+        f(digit2, (scalar.k2_neg ? -endo : endo));
+    }
+}
+
+/*
+  The buckets of a single window of the bucket method: add(digit, base) adds
+  base to bucket_digit, and sum() returns sum_j j * bucket_j. The buckets are
+  combined using a running sum, so the cost is about one addition per base
+  plus 2^(c+1) additions.
+*/
+template<typename T>
+class multi_exp_BDLO12_buckets {
+public:
+    explicit multi_exp_BDLO12_buckets(const size_t c) : buckets(1ul << c, T::zero()) {}
+
+    void add(const size_t digit, const T &base)
+    {
+        buckets[digit] = buckets[digit] + base;
+    }
+
+    T sum()
+    {
+        T running_sum = T::zero();
+        T window_sum = T::zero();
+        for (size_t j = buckets.size() - 1; j > 0; --j)
+        {
+            running_sum = running_sum + buckets[j];
+            window_sum = window_sum + running_sum;
+        }
+
+        return window_sum;
+    }
+
+private:
+    std::vector<T> buckets;
+};
+
+/*
+  Batch-affine bucket accumulation (see multi_exp_BDLO12_affine_buckets):
+  a batch holds at most 2^c / multi_exp_batch_affine_buckets_per_addition
+  additions (so that two additions into the same bucket rarely meet in one
+  batch), and at most multi_exp_batch_affine_max_batch_size. Windows smaller
+  than multi_exp_batch_affine_min_window_size would give batches too small
+  to amortize the shared inversion, and use Jacobian buckets instead.
+*/
+const size_t multi_exp_batch_affine_buckets_per_addition = 16;
+const size_t multi_exp_batch_affine_max_batch_size = 1024;
+const size_t multi_exp_batch_affine_min_window_size = 10;
+
+/*
+  Complete the batch of additions buckets[digits[j]] += bases[j], where the
+  buckets and bases are nonzero and in special form, and each digit occurs
+  at most once. The slopes of all the affine additions share a single field
+  inversion (see batch_invert), so that each addition costs about 6 field
+  multiplications, against 11 for a mixed addition. The rare additions of
+  points with equal x-coordinate (doubling or cancellation) are done in
+  Jacobian coordinates.
+*/
+template<typename T>
+void multi_exp_batch_affine_add(std::vector<T> &buckets,
+                                const std::vector<size_t> &digits,
+                                const std::vector<T> &bases,
+                                std::vector<typename batch_affine_addition<T>::coordinate_field> &inverses)
+{
+    typedef typename batch_affine_addition<T>::coordinate_field coordinate_field;
+
+    inverses.clear();
+    for (size_t j = 0; j < digits.size(); ++j)
+    {
+        const coordinate_field dx = bases[j].X - buckets[digits[j]].X;
+        inverses.emplace_back(dx.is_zero() ? coordinate_field::one() : dx);
+    }
+
+    batch_invert<coordinate_field>(inverses);
+
+    for (size_t j = 0; j < digits.size(); ++j)
+    {
+        T &bucket = buckets[digits[j]];
+        const T &base = bases[j];
+
+        if (base.X == bucket.X)
+        {
+            bucket = bucket + base;
+            if (!bucket.is_zero())
+            {
+                bucket.to_special();
+            }
+            continue;
+        }
+
+        const coordinate_field lambda = (base.Y - bucket.Y) * inverses[j];
+        const coordinate_field X3 = lambda.squared() - bucket.X - base.X;
+        const coordinate_field Y3 = lambda * (bucket.X - X3) - bucket.Y;
+        bucket = T(X3, Y3, coordinate_field::one());
+    }
+}
+
+/*
+  Variant of multi_exp_BDLO12_buckets for bases in special form, with the
+  buckets kept in affine coordinates. Additions into the buckets are
+  collected into batches that are completed by multi_exp_batch_affine_add;
+  a base whose bucket already has an addition pending in the current batch
+  is instead added (with a mixed addition) into a separate Jacobian bucket.
+*/
+template<typename T>
+class multi_exp_BDLO12_affine_buckets {
+public:
+    typedef typename batch_affine_addition<T>::coordinate_field coordinate_field;
+
+    explicit multi_exp_BDLO12_affine_buckets(const size_t c) :
+        batch_size(std::min(multi_exp_batch_affine_max_batch_size,
+                            (1ul << c) / multi_exp_batch_affine_buckets_per_addition)),
+        buckets(1ul << c, T::zero()),
+        overflow_buckets(1ul << c, T::zero()),
+        pending(1ul << c, false)
+    {
+        batch_digits.reserve(batch_size);
+        batch_bases.reserve(batch_size);
+        inverses.reserve(batch_size);
+    }
+
+    void add(const size_t digit, const T &base)
+    {
+        if (base.is_zero())
+        {
+            return;
+        }
+
+        if (pending[digit])
+        {
+            overflow_buckets[digit] = overflow_buckets[digit].mixed_add(base);
+        }
+        else if (buckets[digit].is_zero())
+        {
+            buckets[digit] = base;
+        }
+        else
+        {
+            pending[digit] = true;
+            batch_digits.emplace_back(digit);
+            batch_bases.emplace_back(base);
+            if (batch_digits.size() == batch_size)
+            {
+                complete_batch();
+            }
+        }
+    }
+
+    T sum()
+    {
+        complete_batch();
+
+        T running_sum = T::zero();
+        T window_sum = T::zero();
+        for (size_t j = buckets.size() - 1; j > 0; --j)
+        {
+            running_sum = running_sum + overflow_buckets[j];
+            running_sum = running_sum.mixed_add(buckets[j]);
+            window_sum = window_sum + running_sum;
+        }
+
+        return window_sum;
+    }
+
+private:
+    const size_t batch_size;
+
+    std::vector<T> buckets;
+    std::vector<T> overflow_buckets;
+    std::vector<bool> pending;
+
+    std::vector<size_t> batch_digits;
+    std::vector<T> batch_bases;
+    std::vector<coordinate_field> inverses;
+
+    void complete_batch()
+    {
+        multi_exp_batch_affine_add<T>(buckets, batch_digits, batch_bases, inverses);
+        for (const size_t digit : batch_digits)
+        {
+            pending[digit] = false;
+        }
+        batch_digits.clear();
+        batch_bases.clear();
+    }
+};
+
+/*
+  Compute the window sums (see multi_exp_BDLO12_buckets) at the given offset
+  of several scalar vectors over the same bases (in the given range), in a
+  single pass over the bases: each base is loaded once and added into the
+  buckets of every scalar vector.
+*/
+template<typename T, typename BucketsT, typename ScalarT>
+std::vector<T> multi_exp_BDLO12_window_sums(typename std::vector<T>::const_iterator vec_start,
+                                            const std::vector<const std::vector<ScalarT>*> &scalars,
+                                            const size_t begin,
+                                            const size_t end,
+                                            const size_t offset,
+                                            const size_t c)
+{
+    std::vector<BucketsT> buckets(scalars.size(), BucketsT(c));
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const T &base = *(vec_start + i);
+        for (size_t s = 0; s < scalars.size(); ++s)
+        {
+            BucketsT &b = buckets[s];
+            multi_exp_BDLO12_for_each_digit(base, (*scalars[s])[i], offset, c,
+                                            [&b](const size_t digit, const T &point) {
+                                                b.add(digit, point);
+                                            });
+        }
+    }
+
+    std::vector<T> result;
+    result.reserve(scalars.size());
+    for (BucketsT &b : buckets)
+    {
+        result.emplace_back(b.sum());
+    }
+
+    return result;
+}
+
+template<typename T, typename ScalarT>
+std::vector<T> multi_exp_BDLO12_window_sums(typename std::vector<T>::const_iterator vec_start,
+                                            const std::vector<const std::vector<ScalarT>*> &scalars,
+                                            const size_t begin,
+                                            const size_t end,
+                                            const size_t offset,
+                                            const size_t c,
+                                            std::true_type)
+{
+    return multi_exp_BDLO12_window_sums<T, multi_exp_BDLO12_affine_buckets<T> >(vec_start, scalars, begin, end, offset, c);
+}
+
+template<typename T, typename ScalarT>
+std::vector<T> multi_exp_BDLO12_window_sums(typename std::vector<T>::const_iterator vec_start,
+                                            const std::vector<const std::vector<ScalarT>*> &scalars,
+                                            const size_t begin,
+                                            const size_t end,
+                                            const size_t offset,
+                                            const size_t c,
+                                            std::false_type)
+{
+    return multi_exp_BDLO12_window_sums<T, multi_exp_BDLO12_buckets<T> >(vec_start, scalars, begin, end, offset, c);
+}
+
+/*
+  Compute the window sums of the bucket method for one window, with
+  batch-affine accumulation if requested (which requires all bases to be in
+  special form) and worthwhile for the window size.
+*/
+template<typename T, typename ScalarT>
+std::vector<T> multi_exp_BDLO12_window_sums(typename std::vector<T>::const_iterator vec_start,
+                                            const std::vector<const std::vector<ScalarT>*> &scalars,
+                                            const size_t begin,
+                                            const size_t end,
+                                            const size_t offset,
+                                            const size_t c,
+                                            const bool batch_affine)
+{
+    if (batch_affine && c >= multi_exp_batch_affine_min_window_size)
+    {
+        return multi_exp_BDLO12_window_sums<T>(vec_start, scalars, begin, end, offset, c,
+                                               std::integral_constant<bool, batch_affine_addition<T>::available>());
+    }
+    else
+    {
+        return multi_exp_BDLO12_window_sums<T>(vec_start, scalars, begin, end, offset, c, std::false_type());
+    }
+}
+
+template<typename T, typename ScalarT>
+T multi_exp_BDLO12_window_sum(typename std::vector<T>::const_iterator vec_start,
+                              const std::vector<ScalarT> &scalars,
+                              const size_t begin,
+                              const size_t end,
+                              const size_t offset,
+                              const size_t c,
+                              const bool batch_affine)
+{
+    return multi_exp_BDLO12_window_sums<T, ScalarT>(vec_start, { &scalars }, begin, end, offset, c, batch_affine)[0];
+}
+
+/*
+  The multi-exponentiation algorithm below is the bucket method of Pippenger,
+  as described in Section 4 of
+  [Bernstein, Doumen, Lange, and Oosterwijk, "Faster batch forgery identification", INDOCRYPT '12].
+
+  The scalars are split into windows of c bits. For each window (starting from
+  the most significant one) every base is added into the bucket indexed by
+  its c-bit digit, and the buckets are then combined as sum_j j * bucket_j
+  (see multi_exp_BDLO12_window_sum above). If batch_affine is set, all bases
+  must be in special form, and the buckets may be accumulated in affine
+  coordinates (see multi_exp_BDLO12_batch_affine_window_sum above).
+*/
 template<typename T, typename FieldT>
-T multi_exp(typename std::vector<T>::const_iterator vec_start,
-            typename std::vector<T>::const_iterator vec_end,
-            typename std::vector<FieldT>::const_iterator scalar_start,
-            typename std::vector<FieldT>::const_iterator scalar_end,
-            const size_t chunks,
-            const bool use_multiexp)
+T multi_exp_inner_BDLO12(typename std::vector<T>::const_iterator vec_start,
+                         typename std::vector<T>::const_iterator vec_end,
+                         typename std::vector<FieldT>::const_iterator scalar_start,
+                         typename std::vector<FieldT>::const_iterator scalar_end,
+                         const bool batch_affine)
 {
-    const size_t total = vec_end - vec_start;
-    if (total < chunks)
+    const mp_size_t n = std::remove_reference<decltype(*scalar_start)>::type::num_limbs;
+
+    const size_t length = vec_end - vec_start;
+    assert(length == (size_t)(scalar_end - scalar_start));
+
+    typedef multi_exp_BDLO12_scalar<T, n> scalar_traits;
+
+    std::vector<typename scalar_traits::type> scalars(length);
+    size_t num_bits = 0;
+    for (size_t i = 0; i < length; ++i)
     {
-        return naive_exp<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end);
+        multi_exp_BDLO12_convert<T, n>((scalar_start + i)->as_bigint(), scalars[i]);
+        num_bits = std::max(num_bits, scalars[i].num_bits());
     }
 
-    const size_t one = total/chunks;
+    if (num_bits == 0)
+    {
+        return T::zero();
+    }
 
-    std::vector<T> partial(chunks, T::zero());
+    const size_t c = get_multi_exp_BDLO12_window_size(length * scalar_traits::num_parts, num_bits);
+    const size_t num_windows = (num_bits + c - 1) / c;
 
-    if (use_multiexp)
+    T result = T::zero();
+
+    for (size_t k = num_windows; k-- > 0; )
     {
+        for (size_t i = 0; i < c; ++i)
+        {
+            result = result.dbl();
+        }
+
+        result = result + multi_exp_BDLO12_window_sum<T>(vec_start, scalars, 0, length, k*c, c, batch_affine);
+    }
+
+    return result;
+}
+
+/*
+  Run num_tasks independent tasks, handing them out to the available threads
+  one at a time: a thread that is done with its task picks up the next
+  unclaimed one, so no thread idles while work remains. In DEBUG builds, the
+  per-thread share of busy time is reported inside the given profiling block.
+*/
+template<typename TaskT>
+void multi_exp_run_tasks(const std::string &block_name, const size_t num_tasks, TaskT task)
+{
+#ifdef DEBUG
 #ifdef MULTICORE
-#pragma omp parallel for
+    const size_t num_threads = omp_get_max_threads();
+#else
+    const size_t num_threads = 1;
+#endif
+
+    std::vector<long long> busy_time(num_threads, 0);
+    std::vector<size_t> task_count(num_threads, 0);
+#endif
+
+    enter_block(block_name);
+#ifdef DEBUG
+    const long long start_time = get_nsec_time();
+#endif
+
+#ifdef MULTICORE
+#pragma omp parallel for schedule(dynamic, 1)
 #endif
-        for (size_t i = 0; i < chunks; ++i)
+    for (size_t i = 0; i < num_tasks; ++i)
+    {
+#ifdef DEBUG
+#ifdef MULTICORE
+        const size_t thread = omp_get_thread_num();
+#else
+        const size_t thread = 0;
+#endif
+        const long long task_start_time = get_nsec_time();
+        task(i);
+        busy_time[thread] += get_nsec_time() - task_start_time;
+        ++task_count[thread];
+#else
+        task(i);
+#endif
+    }
+
+#ifdef DEBUG
+    const long long elapsed_time = get_nsec_time() - start_time;
+
+    if (!inhibit_profiling_info)
+    {
+        for (size_t i = 0; i < num_threads; ++i)
         {
-            partial[i] = multi_exp_inner<T, FieldT>(vec_start + i*one,
-                                                    (i == chunks-1 ? vec_end : vec_start + (i+1)*one),
-                                                    scalar_start + i*one,
-                                                    (i == chunks-1 ? scalar_end : scalar_start + (i+1)*one));
+            print_indent(); printf("* Thread %zu: %zu tasks, busy %0.2f%% of %0.4fs\n",
+                                   i, task_count[i], (elapsed_time ? 100. * busy_time[i] / elapsed_time : 0.), elapsed_time * 1e-9);
         }
     }
-    else
+#endif
+
+    leave_block(block_name);
+}
+
+/*
+  Parallel version of multi_exp_inner_BDLO12, for several scalar vectors
+  over the same bases (scalar_starts holds the start of each vector, and
+  each has as many elements as there are bases): the work is split into
+  tasks, one per (window, range of terms) pair, each of which computes the
+  window sums of all the scalar vectors in a single pass over its bases.
+  The per-window sums are combined at the end. The number of ranges is
+  chosen so that there are about multi_exp_tasks_per_thread tasks per thread.
+*/
+template<typename T, typename FieldT>
+std::vector<T> multi_exp_batch_parallel_BDLO12(typename std::vector<T>::const_iterator vec_start,
+                                               typename std::vector<T>::const_iterator vec_end,
+                                               const std::vector<typename std::vector<FieldT>::const_iterator> &scalar_starts,
+                                               const size_t num_threads,
+                                               const bool batch_affine)
+{
+    const mp_size_t n = FieldT::num_limbs;
+
+    const size_t length = vec_end - vec_start;
+    const size_t num_vectors = scalar_starts.size();
+
+    typedef multi_exp_BDLO12_scalar<T, n> scalar_traits;
+    typedef typename scalar_traits::type scalar_type;
+
+    std::vector<std::vector<scalar_type> > scalars(num_vectors, std::vector<scalar_type>(length));
+    std::vector<const std::vector<scalar_type>*> scalar_ptrs;
+    for (size_t s = 0; s < num_vectors; ++s)
     {
+        scalar_ptrs.emplace_back(&scalars[s]);
 #ifdef MULTICORE
 #pragma omp parallel for
 #endif
-        for (size_t i = 0; i < chunks; ++i)
+        for (size_t i = 0; i < length; ++i)
+        {
+            multi_exp_BDLO12_convert<T, n>((scalar_starts[s] + i)->as_bigint(), scalars[s][i]);
+        }
+    }
+
+    /* the window size is chosen for the vector with the most nonzero scalars */
+    size_t num_bits = 0;
+    size_t num_terms = 0;
+    for (size_t s = 0; s < num_vectors; ++s)
+    {
+        size_t nonzero = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            const size_t bits = scalars[s][i].num_bits();
+            num_bits = std::max(num_bits, bits);
+            nonzero += (bits != 0 ? 1 : 0);
+        }
+        num_terms = std::max(num_terms, nonzero);
+    }
+
+    if (num_bits == 0)
+    {
+        return std::vector<T>(num_vectors, T::zero());
+    }
+
+    const size_t min_num_tasks = num_threads * multi_exp_tasks_per_thread;
+
+    size_t c = get_multi_exp_BDLO12_window_size(num_terms * scalar_traits::num_parts, num_bits);
+    size_t num_windows = (num_bits + c - 1) / c;
+    const size_t num_ranges = std::min(length, std::max((size_t)1, (min_num_tasks + num_windows - 1) / num_windows));
+    if (num_ranges > 1)
+    {
+        c = get_multi_exp_BDLO12_window_size((num_terms / num_ranges) * scalar_traits::num_parts, num_bits);
+        num_windows = (num_bits + c - 1) / c;
+    }
+
+    const size_t range_size = length / num_ranges;
+    std::vector<std::vector<T> > partial(num_windows * num_ranges);
+
+    multi_exp_run_tasks("Parallel multi-exponentiation (BDLO12)", partial.size(), [&](const size_t task) {
+            const size_t k = task / num_ranges;
+            const size_t r = task % num_ranges;
+            partial[task] = multi_exp_BDLO12_window_sums<T>(vec_start, scalar_ptrs,
+                                                             r * range_size,
+                                                             (r == num_ranges-1 ? length : (r+1) * range_size),
+                                                             k*c, c, batch_affine);
+        });
+
+    std::vector<T> result(num_vectors, T::zero());
+
+    for (size_t s = 0; s < num_vectors; ++s)
+    {
+        for (size_t k = num_windows; k-- > 0; )
         {
-            partial[i] = naive_exp<T, FieldT>(vec_start + i*one,
-                                              (i == chunks-1 ? vec_end : vec_start + (i+1)*one),
-                                              scalar_start + i*one,
-                                              (i == chunks-1 ? scalar_end : scalar_start + (i+1)*one));
+            for (size_t i = 0; i < c; ++i)
+            {
+                result[s] = result[s].dbl();
+            }
+
+            for (size_t r = 0; r < num_ranges; ++r)
+            {
+                result[s] = result[s] + partial[k * num_ranges + r][s];
+            }
         }
     }
 
+    return result;
+}
+
+template<typename T, typename FieldT>
+T multi_exp_parallel_BDLO12(typename std::vector<T>::const_iterator vec_start,
+                            typename std::vector<T>::const_iterator vec_end,
+                            typename std::vector<FieldT>::const_iterator scalar_start,
+                            typename std::vector<FieldT>::const_iterator scalar_end,
+                            const size_t num_threads,
+                            const bool batch_affine)
+{
+    assert(vec_end - vec_start == scalar_end - scalar_start);
+    return multi_exp_batch_parallel_BDLO12<T, FieldT>(vec_start, vec_end, { scalar_start }, num_threads, batch_affine)[0];
+}
+
+template<typename T, typename FieldT>
+T multi_exp_chunk(typename std::vector<T>::const_iterator vec_start,
+                  typename std::vector<T>::const_iterator vec_end,
+                  typename std::vector<FieldT>::const_iterator scalar_start,
+                  typename std::vector<FieldT>::const_iterator scalar_end,
+                  const multi_exp_method method)
+{
+    switch (method)
+    {
+    case multi_exp_method_naive_plain:
+        return naive_plain_exp<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end);
+    case multi_exp_method_bos_coster:
+        return multi_exp_inner<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end);
+    case multi_exp_method_BDLO12:
+        return multi_exp_inner_BDLO12<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end, false);
+    case multi_exp_method_naive:
+    default:
+        return naive_exp<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end);
+    }
+}
+
+template<typename T, typename FieldT>
+T multi_exp(typename std::vector<T>::const_iterator vec_start,
+            typename std::vector<T>::const_iterator vec_end,
+            typename std::vector<FieldT>::const_iterator scalar_start,
+            typename std::vector<FieldT>::const_iterator scalar_end,
+            const size_t chunks,
+            const multi_exp_method method)
+{
+    const size_t total = vec_end - vec_start;
+    if (total < chunks)
+    {
+        return naive_exp<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end);
+    }
+
+    if (chunks == 1)
+    {
+        return multi_exp_chunk<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end, method);
+    }
+
+    if (method == multi_exp_method_BDLO12)
+    {
+        return multi_exp_parallel_BDLO12<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end, chunks, false);
+    }
+
+    /*
+      Split the input into more pieces than there are threads, so that pieces
+      whose cost is data-dependent (e.g. for Bos-Coster) can be balanced out.
+    */
+    const size_t num_tasks = std::min(total, chunks * multi_exp_tasks_per_thread);
+    const size_t one = total/num_tasks;
+
+    std::vector<T> partial(num_tasks, T::zero());
+
+    multi_exp_run_tasks("Parallel multi-exponentiation", num_tasks, [&](const size_t i) {
+            partial[i] = multi_exp_chunk<T, FieldT>(vec_start + i*one,
+                                                    (i == num_tasks-1 ? vec_end : vec_start + (i+1)*one),
+                                                    scalar_start + i*one,
+                                                    (i == num_tasks-1 ? scalar_end : scalar_start + (i+1)*one),
+                                                    method);
+        });
+
     T final = T::zero();
 
-    for (size_t i = 0; i < chunks; ++i)
+    for (size_t i = 0; i < num_tasks; ++i)
     {
         final = final + partial[i];
     }
@@ -321,13 +990,61 @@ T multi_exp(typename std::vector<T>::const_iterator vec_start,
     return final;
 }
 
+template<typename T>
+bool multi_exp_all_special(typename std::vector<T>::const_iterator vec_start,
+                           typename std::vector<T>::const_iterator vec_end,
+                           std::true_type)
+{
+    return std::all_of(vec_start, vec_end, [](const T &el) { return el.is_special(); });
+}
+
+template<typename T>
+bool multi_exp_all_special(typename std::vector<T>::const_iterator vec_start,
+                           typename std::vector<T>::const_iterator vec_end,
+                           std::false_type)
+{
+    return false;
+}
+
+/*
+  Multi-exponentiation of the bases collected by multi_exp_with_mixed_addition
+  (and its knowledge commitment counterpart), which are normally in special
+  form, like the bases of a proving key. If the BDLO12 method is used, T
+  supports batch-affine addition (see batch_affine_addition) and all bases
+  are indeed in special form, the buckets are accumulated in affine
+  coordinates.
+*/
+template<typename T, typename FieldT>
+T multi_exp_special(typename std::vector<T>::const_iterator vec_start,
+                    typename std::vector<T>::const_iterator vec_end,
+                    typename std::vector<FieldT>::const_iterator scalar_start,
+                    typename std::vector<FieldT>::const_iterator scalar_end,
+                    const size_t chunks,
+                    const multi_exp_method method)
+{
+    if (method == multi_exp_method_BDLO12 &&
+        multi_exp_all_special<T>(vec_start, vec_end, std::integral_constant<bool, batch_affine_addition<T>::available>()))
+    {
+        if (chunks == 1)
+        {
+            return multi_exp_inner_BDLO12<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end, true);
+        }
+        else
+        {
+            return multi_exp_parallel_BDLO12<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end, chunks, true);
+        }
+    }
+
+    return multi_exp<T, FieldT>(vec_start, vec_end, scalar_start, scalar_end, chunks, method);
+}
+
 template<typename T, typename FieldT>
 T multi_exp_with_mixed_addition(typename std::vector<T>::const_iterator vec_start,
                                 typename std::vector<T>::const_iterator vec_end,
                                 typename std::vector<FieldT>::const_iterator scalar_start,
                                 typename std::vector<FieldT>::const_iterator scalar_end,
                                 const size_t chunks,
-                                const bool use_multiexp)
+                                const multi_exp_method method)
 {
     assert(std::distance(vec_start, vec_end) == std::distance(scalar_start, scalar_end));
     enter_block("Process scalar vector");
@@ -374,7 +1091,7 @@ T multi_exp_with_mixed_addition(typename std::vector<T>::const_iterator vec_star
 
     leave_block("Process scalar vector");
 
-    return acc + multi_exp<T, FieldT>(g.begin(), g.end(), p.begin(), p.end(), chunks, use_multiexp);
+    return acc + multi_exp_special<T, FieldT>(g.begin(), g.end(), p.begin(), p.end(), chunks, method);
 }
 
 template<typename T>
@@ -555,33 +1272,7 @@ template<typename T>
 void batch_to_special(std::vector<T> &vec)
 {
     enter_block("Batch-convert elements to special form");
-
-    std::vector<T> non_zero_vec;
-    for (size_t i = 0; i < vec.size(); ++i)
-    {
-        if (!vec[i].is_zero())
-        {
-            non_zero_vec.emplace_back(vec[i]);
-        }
-    }
-
-    batch_to_special_all_non_zeros<T>(non_zero_vec);
-    auto it = non_zero_vec.begin();
-    T zero_special = T::zero();
-    zero_special.to_special();
-
-    for (size_t i = 0; i < vec.size(); ++i)
-    {
-        if (!vec[i].is_zero())
-        {
-            vec[i] = *it;
-            ++it;
-        }
-        else
-        {
-            vec[i] = zero_special;
-        }
-    }
+    batch_to_special_all_non_zeros<T>(vec);
     leave_block("Batch-convert elements to special form");
 }
 
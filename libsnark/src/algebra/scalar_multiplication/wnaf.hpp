@@ -32,6 +32,20 @@ T fixed_window_wnaf_exp(const size_t window_size, const T &base, const bigint<n>
 template<typename T, mp_size_t n>
 T opt_window_wnaf_exp(const T &base, const bigint<n> &scalar, const size_t scalar_bits);
 
+/**
+ * In additive notation, use the GLV endomorphism of T (see glv_endomorphism) to split
+ * the scalar into two halves, and then use interleaved wNAF exponentiation (with the given
+ * window size) on base and its image under the endomorphism to compute scalar * base.
+ */
+template<typename T, mp_size_t n>
+T fixed_window_glv_wnaf_exp(const size_t window_size, const T &base, const bigint<n> &scalar);
+
+/**
+ * As above, but with the window size determined by T and the length of the halves of the scalar.
+ */
+template<typename T, mp_size_t n>
+T opt_window_glv_wnaf_exp(const T &base, const bigint<n> &scalar, const size_t scalar_bits);
+
 } // libsnark
 
 #include "algebra/scalar_multiplication/wnaf.tcc"
@@ -14,6 +14,8 @@
 #ifndef WNAF_TCC_
 #define WNAF_TCC_
 
+#include "algebra/curves/curve_utils.hpp"
+
 namespace libsnark {
 
 template<mp_size_t n>
@@ -118,6 +120,93 @@ T opt_window_wnaf_exp(const T &base, const bigint<n> &scalar, const size_t scala
     }
 }
 
+template<typename T, mp_size_t n>
+T fixed_window_glv_wnaf_exp(const size_t window_size, const T &base, const bigint<n> &scalar)
+{
+    bigint<n> k1, k2;
+    bool k1_neg, k2_neg;
+    glv_endomorphism<T>::decompose(scalar, k1, k1_neg, k2, k2_neg);
+
+    std::vector<long> naf1 = find_wnaf(window_size, k1);
+    std::vector<long> naf2 = find_wnaf(window_size, k2);
+    assert(naf1.size() == naf2.size());
+
+    /* table1 holds the odd multiples of (+/-)base, and table2 their images under the endomorphism, with the sign of k2 */
+    std::vector<T> table1(1ul<<(window_size-1));
+    std::vector<T> table2(1ul<<(window_size-1));
+    T tmp = (k1_neg ? -base : base);
+    T dbl = tmp.dbl();
+    for (size_t i = 0; i < 1ul<<(window_size-1); ++i)
+    {
+        table1[i] = tmp;
+        table2[i] = glv_endomorphism<T>::apply(k1_neg == k2_neg ? tmp : -tmp);
+        tmp = tmp + dbl;
+    }
+
+    T res = T::zero();
+    bool found_nonzero = false;
+    for (long i = naf1.size()-1; i >= 0; --i)
+    {
+        if (found_nonzero)
+        {
+            res = res.dbl();
+        }
+
+        if (naf1[i] != 0)
+        {
+            found_nonzero = true;
+            if (naf1[i] > 0)
+            {
+                res = res + table1[naf1[i]/2];
+            }
+            else
+            {
+                res = res - table1[(-naf1[i])/2];
+            }
+        }
+
+        if (naf2[i] != 0)
+        {
+            found_nonzero = true;
+            if (naf2[i] > 0)
+            {
+                res = res + table2[naf2[i]/2];
+            }
+            else
+            {
+                res = res - table2[(-naf2[i])/2];
+            }
+        }
+    }
+
+    return res;
+}
+
+template<typename T, mp_size_t n>
+T opt_window_glv_wnaf_exp(const T &base, const bigint<n> &scalar, const size_t scalar_bits)
+{
+    const size_t half_bits = (scalar_bits + 1) / 2;
+
+    size_t best = 0;
+    for (long i = T::wnaf_window_table.size() - 1; i >= 0; --i)
+    {
+        if (half_bits >= T::wnaf_window_table[i])
+        {
+            best = i+1;
+            break;
+        }
+    }
+
+    if (best > 0)
+    {
+        return fixed_window_glv_wnaf_exp(best, base, scalar);
+    }
+    else
+    {
+        return scalar * base;
+    }
+}
+
 } // libsnark
 
 #endif // WNAF_TCC_
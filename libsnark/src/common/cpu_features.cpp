@@ -0,0 +1,84 @@
+/** @file
+ *****************************************************************************
+ Implementation of run-time detection of optional CPU instructions
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#include "common/cpu_features.hpp"
+
+namespace libsnark {
+
+#if defined(__x86_64__)
+/* registers of CPUID leaf 7, subleaf 0 (structured extended features) */
+static bool cpuid_leaf7(unsigned int &ebx, unsigned int &ecx)
+{
+    unsigned int eax, edx;
+    if (__get_cpuid_max(0, nullptr) < 7)
+    {
+        return false;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return true;
+}
+
+/* the register state the OS saves on context switches, per XCR0 */
+static unsigned long long xcr0()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE))
+    {
+        return 0;
+    }
+    unsigned int lo, hi;
+    __asm__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+    return ((unsigned long long) hi << 32) | lo;
+}
+#endif
+
+static bool detect_mulx_adx()
+{
+#if defined(__x86_64__)
+    unsigned int ebx, ecx;
+    return cpuid_leaf7(ebx, ecx) && (ebx & bit_BMI2) && (ebx & bit_ADX);
+#else
+    return false;
+#endif
+}
+
+static bool detect_avx2()
+{
+#if defined(__x86_64__)
+    /* SSE and AVX state */
+    const unsigned long long ymm_state = 0x6;
+    unsigned int ebx, ecx;
+    return (xcr0() & ymm_state) == ymm_state && cpuid_leaf7(ebx, ecx) && (ebx & bit_AVX2);
+#else
+    return false;
+#endif
+}
+
+static bool detect_avx512ifma()
+{
+#if defined(__x86_64__)
+    /* SSE, AVX, opmask and both halves of the AVX-512 state */
+    const unsigned long long zmm_state = 0xe6;
+    unsigned int ebx, ecx;
+    return (xcr0() & zmm_state) == zmm_state && cpuid_leaf7(ebx, ecx) &&
+        (ebx & bit_AVX512F) && (ebx & bit_AVX512IFMA);
+#else
+    return false;
+#endif
+}
+
+bool cpu_has_mulx_adx = detect_mulx_adx();
+bool cpu_has_avx2 = detect_avx2();
+bool cpu_has_avx512ifma = detect_avx512ifma();
+
+} // libsnark
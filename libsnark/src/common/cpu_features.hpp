@@ -0,0 +1,33 @@
+/** @file
+ *****************************************************************************
+ Declaration of run-time detection of optional CPU instructions
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef CPU_FEATURES_HPP_
+#define CPU_FEATURES_HPP_
+
+namespace libsnark {
+
+/*
+  Each flag is set from CPUID during static initialization, and is false
+  before that and on other architectures. Code that has a faster path for
+  an instruction set tests the flag and otherwise takes its generic path;
+  clearing a flag forces the generic path.
+ */
+
+/* MULX (BMI2) and ADCX/ADOX (ADX) */
+extern bool cpu_has_mulx_adx;
+
+/* AVX2, with the OS saving the YMM registers */
+extern bool cpu_has_avx2;
+
+/* AVX-512F and AVX-512 IFMA, with the OS saving the ZMM and mask registers */
+extern bool cpu_has_avx512ifma;
+
+} // libsnark
+
+#endif // CPU_FEATURES_HPP_
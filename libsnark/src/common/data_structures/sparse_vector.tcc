@@ -129,7 +129,7 @@ bool sparse_vector<T>::operator==(const std::vector<T> &other) const
 template<typename T>
 bool sparse_vector<T>::is_valid() const
 {
-    if (values.size() == indices.size() && values.size() <= domain_size_)
+    if (values.size() != indices.size() || values.size() > domain_size_)
     {
         return false;
     }
@@ -182,7 +182,7 @@ std::pair<T, sparse_vector<T> > sparse_vector<T>::accumulate(const typename std:
 {
     // TODO: does not really belong here.
     const size_t chunks = 1;
-    const bool use_multiexp = true;
+    const multi_exp_method method = multi_exp_method_bos_coster;
 
     T accumulated_value = T::zero();
     sparse_vector<T> resulting_vector;
@@ -219,7 +219,7 @@ std::pair<T, sparse_vector<T> > sparse_vector<T>::accumulate(const typename std:
                                                                              values.begin() + last_pos + 1,
                                                                              it_begin + (indices[first_pos] - offset),
                                                                              it_begin + (indices[last_pos] - offset) + 1,
-                                                                             chunks, use_multiexp);
+                                                                             chunks, method);
             }
         }
         else
@@ -254,7 +254,7 @@ std::pair<T, sparse_vector<T> > sparse_vector<T>::accumulate(const typename std:
                                                                      values.begin() + last_pos + 1,
                                                                      it_begin + (indices[first_pos] - offset),
                                                                      it_begin + (indices[last_pos] - offset) + 1,
-                                                                     chunks, use_multiexp);
+                                                                     chunks, method);
     }
 
     return std::make_pair(accumulated_value, resulting_vector);
@@ -0,0 +1,100 @@
+/** @file
+ *****************************************************************************
+ Implementation of memory mappings of files
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/mapped_file.hpp"
+
+namespace libsnark {
+
+mapped_file::mapped_file(const std::string &path) : data_(nullptr), size_(0)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("could not open " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("could not stat " + path);
+    }
+
+    size_ = st.st_size;
+    if (size_ > 0)
+    {
+        void *addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("could not map " + path);
+        }
+
+        /* the contents are consumed front to back, so let the kernel read ahead */
+        madvise(addr, size_, MADV_SEQUENTIAL);
+        madvise(addr, size_, MADV_WILLNEED);
+        data_ = (const char*) addr;
+    }
+
+    /* the mapping stays valid after the descriptor is closed */
+    close(fd);
+}
+
+mapped_file::~mapped_file()
+{
+    if (data_ != nullptr)
+    {
+        munmap((void*) data_, size_);
+    }
+}
+
+scratch_file::scratch_file(const std::string &dir, const size_t size) : data_(nullptr), size_(size)
+{
+    std::string path = dir + "/libsnark-scratch-XXXXXX";
+    const int fd = mkstemp(&path[0]);
+    if (fd < 0)
+    {
+        throw std::runtime_error("could not create a scratch file in " + dir);
+    }
+    unlink(path.c_str());
+
+    if (size_ > 0)
+    {
+        void *addr = MAP_FAILED;
+        if (ftruncate(fd, size_) == 0)
+        {
+            addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (addr == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("could not map a scratch file in " + dir);
+        }
+        data_ = (char*) addr;
+    }
+
+    close(fd);
+}
+
+scratch_file::~scratch_file()
+{
+    if (data_ != nullptr)
+    {
+        munmap(data_, size_);
+    }
+}
+
+} // libsnark
@@ -0,0 +1,67 @@
+/** @file
+ *****************************************************************************
+ Declaration of memory mappings of files
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef MAPPED_FILE_HPP_
+#define MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string>
+
+namespace libsnark {
+
+/**
+ * A whole file mapped read-only into memory, for the lifetime of the object.
+ *
+ * The file is read straight from the page cache, with no intermediate buffer.
+ * Data kept beyond the lifetime of the object must be copied out of it. The
+ * start of the mapping is page-aligned.
+ */
+class mapped_file {
+public:
+    explicit mapped_file(const std::string &path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file &other) = delete;
+    mapped_file& operator=(const mapped_file &other) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char *data_;
+    size_t size_;
+};
+
+/**
+ * A temporary file of a given size mapped read-write into memory, for the
+ * lifetime of the object.
+ *
+ * The file is created in directory dir and unlinked right away, so it never
+ * outlives the process. Its pages are backed by the file rather than by swap,
+ * so the kernel can write them back and reclaim them under memory pressure.
+ */
+class scratch_file {
+public:
+    scratch_file(const std::string &dir, const size_t size);
+    ~scratch_file();
+
+    scratch_file(const scratch_file &other) = delete;
+    scratch_file& operator=(const scratch_file &other) = delete;
+
+    char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    char *data_;
+    size_t size_;
+};
+
+} // libsnark
+
+#endif // MAPPED_FILE_HPP_
@@ -17,6 +17,7 @@
 #include <chrono>
 #include <cstdio>
 #include <list>
+#include <mutex>
 #include <vector>
 #include <ctime>
 #include "common/default_types/ec_pp.hpp"
@@ -57,18 +58,28 @@ void start_profiling()
 }
 
 std::map<std::string, size_t> invocation_counts;
-std::map<std::string, long long> enter_times;
 std::map<std::string, long long> last_times;
 std::map<std::string, long long> cumulative_times;
 //TODO: Instead of analogous maps for time and cpu_time, use a single struct-valued map
-std::map<std::string, long long> enter_cpu_times;
 std::map<std::string, long long> last_cpu_times;
 std::map<std::pair<std::string, std::string>, long long> op_counts;
 std::map<std::pair<std::string, std::string>, long long> cumulative_op_counts; // ((msg, data_point), value)
     // TODO: Convert op_counts and cumulative_op_counts from pair to structs
-size_t indentation = 0;
 
-std::vector<std::string> block_names;
+/* a block entered and not yet left */
+struct open_block {
+    std::string name;
+    long long enter_time;
+    long long enter_cpu_time;
+    bool indented;
+};
+
+/* the blocks of each thread nest on their own, so their state is per thread */
+static thread_local std::vector<open_block> open_blocks;
+static thread_local size_t indentation = 0;
+
+/* serializes the updates of the counters above by concurrent threads */
+std::mutex block_mutex;
 
 std::list<std::pair<std::string, long long*> > op_data_points = {
 #ifdef PROFILE_OP_COUNTS
@@ -90,6 +101,18 @@ std::list<std::pair<std::string, long long*> > op_data_points = {
 bool inhibit_profiling_info = false;
 bool inhibit_profiling_counters = false;
 
+static thread_local block_observer current_block_observer;
+
+void set_block_observer(const block_observer &observer)
+{
+    current_block_observer = observer;
+}
+
+block_observer get_block_observer()
+{
+    return current_block_observer;
+}
+
 void clear_profiling_counters()
 {
     invocation_counts.clear();
@@ -239,22 +262,26 @@ void op_profiling_enter(const std::string &msg)
 
 void enter_block(const std::string &msg, const bool indent)
 {
+    if (current_block_observer)
+    {
+        current_block_observer(msg);
+    }
+
     if (inhibit_profiling_counters)
     {
         return;
     }
 
-    block_names.emplace_back(msg);
     long long t = get_nsec_time();
-    enter_times[msg] = t;
     long long cpu_t = get_nsec_cpu_time();
-    enter_cpu_times[msg] = cpu_t;
+    open_blocks.emplace_back(open_block { msg, t, cpu_t, indent && !inhibit_profiling_info });
 
     if (inhibit_profiling_info)
     {
         return;
     }
 
+    std::lock_guard<std::mutex> lock(block_mutex);
 #ifdef MULTICORE
 #pragma omp critical
 #endif
@@ -281,19 +308,20 @@ void leave_block(const std::string &msg, const bool indent)
         return;
     }
 
-#ifndef MULTICORE
-    assert(*(--block_names.end()) == msg);
-#endif
-    block_names.pop_back();
+    assert(!open_blocks.empty() && open_blocks.back().name == msg);
+    const long long enter_time = open_blocks.back().enter_time;
+    const long long enter_cpu_time = open_blocks.back().enter_cpu_time;
+    open_blocks.pop_back();
 
+    std::lock_guard<std::mutex> lock(block_mutex);
     ++invocation_counts[msg];
 
     long long t = get_nsec_time();
-    last_times[msg] = (t - enter_times[msg]);
-    cumulative_times[msg] += (t - enter_times[msg]);
+    last_times[msg] = (t - enter_time);
+    cumulative_times[msg] += (t - enter_time);
 
     long long cpu_t = get_nsec_cpu_time();
-    last_cpu_times[msg] = (cpu_t - enter_cpu_times[msg]);
+    last_cpu_times[msg] = (cpu_t - enter_cpu_time);
 
 #ifdef PROFILE_OP_COUNTS
     for (std::pair<std::string, long long*> p : op_data_points)
@@ -318,13 +346,30 @@ void leave_block(const std::string &msg, const bool indent)
 
         print_indent();
         printf("(leave) %-35s\t", msg.c_str());
-        print_times_from_last_and_start(t, enter_times[msg], cpu_t, enter_cpu_times[msg]);
+        print_times_from_last_and_start(t, enter_time, cpu_t, enter_cpu_time);
         print_op_profiling(msg);
         printf("\n");
         fflush(stdout);
     }
 }
 
+size_t get_block_depth()
+{
+    return open_blocks.size();
+}
+
+void unwind_blocks(const size_t depth)
+{
+    while (open_blocks.size() > depth)
+    {
+        if (open_blocks.back().indented)
+        {
+            --indentation;
+        }
+        open_blocks.pop_back();
+    }
+}
+
 void print_mem(const std::string &s)
 {
 #ifndef NO_PROCPS
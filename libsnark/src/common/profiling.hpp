@@ -15,6 +15,7 @@
 #define PROFILING_HPP_
 
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -43,6 +44,26 @@ void print_cumulative_op_counts(const bool only_fq=false);
 void enter_block(const std::string &msg, const bool indent=true);
 void leave_block(const std::string &msg, const bool indent=true);
 
+/**
+ * Blocks nest per thread. get_block_depth returns the number of blocks the
+ * calling thread has entered and not left; when an exception abandons a
+ * computation, unwind_blocks(depth) drops the blocks it left open on that
+ * thread, without accounting for them.
+ */
+size_t get_block_depth();
+void unwind_blocks(const size_t depth);
+
+/**
+ * A function told the name of every block entered by the thread that
+ * installed it, e.g. to report the progress of a long proof. Observers run
+ * even when profiling counters are inhibited. Installing an empty function
+ * removes the observer of the calling thread. Code that hands work to another
+ * thread can forward the observer returned by get_block_observer to it.
+ */
+typedef std::function<void(const std::string &msg)> block_observer;
+void set_block_observer(const block_observer &observer);
+block_observer get_block_observer();
+
 void print_mem(const std::string &s = "");
 void print_compilation_info();
 
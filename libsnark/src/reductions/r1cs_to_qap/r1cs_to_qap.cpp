@@ -0,0 +1,25 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of the settings of the R1CS-to-QAP reduction.
+
+ See r1cs_to_qap.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#include "reductions/r1cs_to_qap/r1cs_to_qap.hpp"
+
+namespace libsnark {
+
+#ifdef LOWMEM
+bool qap_witness_map_low_memory = true;
+#else
+bool qap_witness_map_low_memory = false;
+#endif
+std::string qap_witness_map_scratch_dir;
+
+} // libsnark
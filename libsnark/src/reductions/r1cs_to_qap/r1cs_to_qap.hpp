@@ -32,11 +32,34 @@
 #ifndef R1CS_TO_QAP_HPP_
 #define R1CS_TO_QAP_HPP_
 
+#include <string>
+
 #include "relations/arithmetic_programs/qap/qap.hpp"
 #include "relations/constraint_satisfaction_problems/r1cs/r1cs.hpp"
 
 namespace libsnark {
 
+/**
+ * When set, r1cs_to_qap_witness_map runs in a memory-bounded mode that holds
+ * at most two domain-sized vectors at any time instead of four, and drops
+ * the cached FFT tables when done (see r1cs_to_qap_witness_map_low_memory).
+ * Defaults to true when compiled with LOWMEM.
+ */
+extern bool qap_witness_map_low_memory;
+
+/**
+ * If non-empty, the memory-bounded witness map keeps its second vector in a
+ * memory-mapped scratch file created in this directory, so that only one
+ * domain-sized vector needs to be resident.
+ */
+extern std::string qap_witness_map_scratch_dir;
+
+/*
+ * The two settings above are read by every call to r1cs_to_qap_witness_map
+ * without synchronization: set them before the first proof starts and leave
+ * them alone while any proof is running.
+ */
+
 /**
  * Instance map for the R1CS-to-QAP reduction.
  */
@@ -63,6 +86,23 @@ qap_witness<FieldT> r1cs_to_qap_witness_map(const r1cs_constraint_system<FieldT>
                                             const FieldT &d2,
                                             const FieldT &d3);
 
+/**
+ * Memory-bounded variant of the witness map above, with the same output.
+ *
+ * The polynomials A, B, C are evaluated and transformed one at a time in a
+ * single buffer, and their contributions are accumulated on the coset into a
+ * second vector; that vector is backed by a scratch file in scratch_dir
+ * unless scratch_dir is empty.
+ */
+template<typename FieldT>
+qap_witness<FieldT> r1cs_to_qap_witness_map_low_memory(const r1cs_constraint_system<FieldT> &cs,
+                                                       const r1cs_primary_input<FieldT> &primary_input,
+                                                       const r1cs_auxiliary_input<FieldT> &auxiliary_input,
+                                                       const FieldT &d1,
+                                                       const FieldT &d2,
+                                                       const FieldT &d3,
+                                                       const std::string &scratch_dir);
+
 } // libsnark
 
 #include "reductions/r1cs_to_qap/r1cs_to_qap.tcc"
@@ -14,9 +14,18 @@
 #ifndef R1CS_TO_QAP_TCC_
 #define R1CS_TO_QAP_TCC_
 
+#include <algorithm>
+#include <memory>
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "common/mapped_file.hpp"
 #include "common/profiling.hpp"
 #include "common/utils.hpp"
 #include "algebra/evaluation_domain/evaluation_domain.hpp"
+#include "algebra/evaluation_domain/domains/basic_radix2_domain_aux.hpp"
+#include "algebra/fields/field_utils.hpp"
 
 namespace libsnark {
 
@@ -173,6 +182,80 @@ qap_instance_evaluation<FieldT> r1cs_to_qap_instance_map_with_evaluation(const r
                                            Zt);
 }
 
+/**
+ * Add to out[i] the evaluation at (1, full_variable_assignment) of the linear
+ * combination lc of the i-th constraint of cs, read from matrix when the
+ * system is frozen (then matrix is its A, B or C matrix) and from cs otherwise.
+ *
+ * The constraints are split into one contiguous block per thread, with equally
+ * many terms per block when the system is frozen, so that each thread streams
+ * through its own part of the matrix and of out. Every out[i] is computed by
+ * a single thread, so the result does not depend on the number of threads.
+ */
+template<typename FieldT>
+void _r1cs_to_qap_add_evaluations(const r1cs_constraint_system<FieldT> &cs,
+                                  const r1cs_sparse_matrix<FieldT> *matrix,
+                                  linear_combination<FieldT> r1cs_constraint<FieldT>::*lc,
+                                  const r1cs_variable_assignment<FieldT> &full_variable_assignment,
+                                  std::vector<FieldT> &out)
+{
+    const size_t n = cs.num_constraints();
+#ifdef MULTICORE
+    const size_t num_chunks = omp_get_max_threads();
+#else
+    const size_t num_chunks = 1;
+#endif
+
+    std::vector<size_t> chunk_start(num_chunks+1, n);
+    for (size_t c = 0; c < num_chunks; ++c)
+    {
+        if (matrix != nullptr)
+        {
+            const size_t first_term = (c * matrix->num_terms()) / num_chunks;
+            chunk_start[c] = std::lower_bound(matrix->row_start.begin(), matrix->row_start.begin() + n, first_term) - matrix->row_start.begin();
+        }
+        else
+        {
+            chunk_start[c] = (c * n) / num_chunks;
+        }
+    }
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t c = 0; c < num_chunks; ++c)
+    {
+        if (matrix != nullptr)
+        {
+            for (size_t i = chunk_start[c]; i < chunk_start[c+1]; ++i)
+            {
+                out[i] += matrix->evaluate_row(i, full_variable_assignment);
+            }
+        }
+        else
+        {
+            for (size_t i = chunk_start[c]; i < chunk_start[c+1]; ++i)
+            {
+                out[i] += (cs.constraints[i].*lc).evaluate(full_variable_assignment);
+            }
+        }
+    }
+}
+
+/*
+ The value of the vanishing polynomial Z of the domain on the coset g*S,
+ which the witness maps merge into their final scaling in place of
+ divide_by_Z_on_coset. Z is only constant on the coset for a multiplicative
+ subgroup S, where Z(z) = z^m - 1 and Z(g*omega^i) = g^m - 1; this holds for
+ basic_radix2_domain, the only domain get_evaluation_domain returns here.
+ */
+template<typename FieldT>
+FieldT r1cs_to_qap_Z_on_coset(evaluation_domain<FieldT> &domain, const FieldT &g)
+{
+    assert(dynamic_cast<basic_radix2_domain<FieldT>*>(&domain) != nullptr);
+    return domain.compute_Z(g);
+}
+
 /**
  * Witness map for the R1CS-to-QAP reduction.
  *
@@ -199,8 +282,9 @@ qap_instance_evaluation<FieldT> r1cs_to_qap_instance_map_with_evaluation(const r
  *  (5) compute coefficients of H
  *  (6) patch H to account for d1,d2,d3 (i.e., add coefficients of the polynomial (A d2 + B d1 - d3) + d1*d2*Z )
  *
- * The code below is not as simple as the above high-level description due to
- * some reshuffling to save space.
+ * The code below is not as simple as the above high-level description, as
+ * the transforms of A,B,C are computed together and the scalings by 1/n, by
+ * powers of the coset generator and by 1/Z are merged into fewer passes.
  */
 template<typename FieldT>
 qap_witness<FieldT> r1cs_to_qap_witness_map(const r1cs_constraint_system<FieldT> &cs,
@@ -210,6 +294,11 @@ qap_witness<FieldT> r1cs_to_qap_witness_map(const r1cs_constraint_system<FieldT>
                                             const FieldT &d2,
                                             const FieldT &d3)
 {
+    if (qap_witness_map_low_memory)
+    {
+        return r1cs_to_qap_witness_map_low_memory(cs, primary_input, auxiliary_input, d1, d2, d3, qap_witness_map_scratch_dir);
+    }
+
     enter_block("Call to r1cs_to_qap_witness_map");
 
     /* sanity check */
@@ -220,8 +309,8 @@ qap_witness<FieldT> r1cs_to_qap_witness_map(const r1cs_constraint_system<FieldT>
     r1cs_variable_assignment<FieldT> full_variable_assignment = primary_input;
     full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
 
-    enter_block("Compute evaluation of polynomials A, B on set S");
-    std::vector<FieldT> aA(domain->m, FieldT::zero()), aB(domain->m, FieldT::zero());
+    enter_block("Compute evaluation of polynomials A, B, C on set S");
+    std::vector<FieldT> aA(domain->m, FieldT::zero()), aB(domain->m, FieldT::zero()), aC(domain->m, FieldT::zero());
 
     /* account for the additional constraints input_i * 0 = 0 */
     for (size_t i = 0; i <= cs.num_inputs(); ++i)
@@ -229,108 +318,277 @@ qap_witness<FieldT> r1cs_to_qap_witness_map(const r1cs_constraint_system<FieldT>
         aA[i+cs.num_constraints()] = (i > 0 ? full_variable_assignment[i-1] : FieldT::one());
     }
     /* account for all other constraints */
-    for (size_t i = 0; i < cs.num_constraints(); ++i)
-    {
-        aA[i] += cs.constraints[i].a.evaluate(full_variable_assignment);
-        aB[i] += cs.constraints[i].b.evaluate(full_variable_assignment);
-    }
-    leave_block("Compute evaluation of polynomials A, B on set S");
+    const std::shared_ptr<const r1cs_frozen_constraint_system<FieldT> > frozen = cs.frozen();
+    _r1cs_to_qap_add_evaluations(cs, frozen ? &frozen->A : nullptr, &r1cs_constraint<FieldT>::a, full_variable_assignment, aA);
+    _r1cs_to_qap_add_evaluations(cs, frozen ? &frozen->B : nullptr, &r1cs_constraint<FieldT>::b, full_variable_assignment, aB);
+    _r1cs_to_qap_add_evaluations(cs, frozen ? &frozen->C : nullptr, &r1cs_constraint<FieldT>::c, full_variable_assignment, aC);
+    leave_block("Compute evaluation of polynomials A, B, C on set S");
 
-    enter_block("Compute coefficients of polynomial A");
-    domain->iFFT(aA);
-    leave_block("Compute coefficients of polynomial A");
+    /* the three transforms are interleaved, and the factors 1/m of the
+       inverse FFTs are deferred to the patch and to the coset FFTs */
+    enter_block("Compute coefficients of polynomials A, B, C");
+    domain->unscaled_iFFT({ &aA, &aB, &aC });
+    leave_block("Compute coefficients of polynomials A, B, C");
 
-    enter_block("Compute coefficients of polynomial B");
-    domain->iFFT(aB);
-    leave_block("Compute coefficients of polynomial B");
+    const FieldT m_inverse = FieldT(domain->m).inverse();
 
     enter_block("Compute ZK-patch");
     std::vector<FieldT> coefficients_for_H(domain->m+1, FieldT::zero());
+    const FieldT d2_over_m = d2 * m_inverse, d1_over_m = d1 * m_inverse;
+    /* the element-wise products are taken by batch_mul, a block at a time */
+    const size_t block = 256;
 #ifdef MULTICORE
 #pragma omp parallel for
 #endif
     /* add coefficients of the polynomial (d2*A + d1*B - d3) + d1*d2*Z */
-    for (size_t i = 0; i < domain->m; ++i)
+    for (size_t i0 = 0; i0 < domain->m; i0 += block)
     {
-        coefficients_for_H[i] = d2*aA[i] + d1*aB[i];
+        const size_t len = std::min(block, domain->m - i0);
+        FieldT tmp[block];
+        batch_mul(&coefficients_for_H[i0], &aA[i0], &d2_over_m, 0, len);
+        batch_mul(tmp, &aB[i0], &d1_over_m, 0, len);
+        for (size_t i = 0; i < len; ++i)
+        {
+            coefficients_for_H[i0+i] += tmp[i];
+        }
     }
     coefficients_for_H[0] -= d3;
     domain->add_poly_Z(d1*d2, coefficients_for_H);
     leave_block("Compute ZK-patch");
 
-    enter_block("Compute evaluation of polynomial A on set T");
-    domain->cosetFFT(aA, FieldT::multiplicative_generator);
-    leave_block("Compute evaluation of polynomial A on set T");
-
-    enter_block("Compute evaluation of polynomial B on set T");
-    domain->cosetFFT(aB, FieldT::multiplicative_generator);
-    leave_block("Compute evaluation of polynomial B on set T");
-
     enter_block("Compute evaluation of polynomial H on set T");
+    enter_block("Compute evaluation of polynomials A, B, C on set T");
+    domain->cosetFFT({ &aA, &aB, &aC }, FieldT::multiplicative_generator, m_inverse);
+    leave_block("Compute evaluation of polynomials A, B, C on set T");
+
+    /* the division by Z on set T is deferred to the coefficients of H */
     std::vector<FieldT> &H_tmp = aA; // can overwrite aA because it is not used later
 #ifdef MULTICORE
 #pragma omp parallel for
 #endif
-    for (size_t i = 0; i < domain->m; ++i)
+    for (size_t i0 = 0; i0 < domain->m; i0 += block)
     {
-        H_tmp[i] = aA[i]*aB[i];
+        const size_t len = std::min(block, domain->m - i0);
+        batch_mul(&H_tmp[i0], &aA[i0], &aB[i0], 1, len);
+        for (size_t i = i0; i < i0 + len; ++i)
+        {
+            H_tmp[i] -= aC[i];
+        }
     }
     std::vector<FieldT>().swap(aB); // destroy aB
+    std::vector<FieldT>().swap(aC); // destroy aC
+    leave_block("Compute evaluation of polynomial H on set T");
 
-    enter_block("Compute evaluation of polynomial C on set S");
-    std::vector<FieldT> aC(domain->m, FieldT::zero());
-    for (size_t i = 0; i < cs.num_constraints(); ++i)
+    enter_block("Compute coefficients of polynomial H");
+    domain->unscaled_iFFT({ &H_tmp });
+    leave_block("Compute coefficients of polynomial H");
+
+    enter_block("Compute sum of H and ZK-patch");
+    /* coefficient i of H is H_tmp[i] * g^{-i} / (m * Z(g)), for g the coset generator */
+    const FieldT g_inverse = FieldT::multiplicative_generator.inverse();
+    const FieldT H_scale = m_inverse * r1cs_to_qap_Z_on_coset(*domain, FieldT::multiplicative_generator).inverse();
+#ifdef MULTICORE
+    const size_t num_chunks = omp_get_max_threads();
+#else
+    const size_t num_chunks = 1;
+#endif
+    const size_t chunk_size = (domain->m + num_chunks - 1) / num_chunks;
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t c = 0; c < num_chunks; ++c)
     {
-        aC[i] += cs.constraints[i].c.evaluate(full_variable_assignment);
+        const size_t begin = std::min(c * chunk_size, domain->m), end = std::min(begin + chunk_size, domain->m);
+        batch_mul_by_powers(&H_tmp[begin], end - begin, H_scale * (g_inverse^begin), g_inverse);
+        for (size_t i = begin; i < end; ++i)
+        {
+            coefficients_for_H[i] += H_tmp[i];
+        }
     }
-    leave_block("Compute evaluation of polynomial C on set S");
+    leave_block("Compute sum of H and ZK-patch");
+
+    leave_block("Call to r1cs_to_qap_witness_map");
 
-    enter_block("Compute coefficients of polynomial C");
-    domain->iFFT(aC);
-    leave_block("Compute coefficients of polynomial C");
+    return qap_witness<FieldT>(cs.num_variables(),
+                               domain->m,
+                               cs.num_inputs(),
+                               d1,
+                               d2,
+                               d3,
+                               full_variable_assignment,
+                               std::move(coefficients_for_H));
+}
 
-    enter_block("Compute evaluation of polynomial C on set T");
-    domain->cosetFFT(aC, FieldT::multiplicative_generator);
-    leave_block("Compute evaluation of polynomial C on set T");
+/**
+ * Memory-bounded witness map for the R1CS-to-QAP reduction.
+ *
+ * Let T be the coset g*S, for g the multiplicative generator, and let A,B,C
+ * be without their d1,d2,d3 terms. The output, less the term d1*d2*Z(z), is
+ *   H'(z) := (A(z)*B(z) - C(z)) / Z(z) + d2*A(z) + d1*B(z) - d3 ,
+ * which has degree less than n. Since Z is the constant Z(g) on T, there
+ *   Z(g) * H' = A * (B + Z(g)*d2) + Z(g)*d1*B - C - Z(g)*d3 .
+ * So H' is recovered from its evaluations on T, which are accumulated one
+ * polynomial at a time: each of A, B, C is evaluated on S, interpolated and
+ * evaluated on T in the same buffer, and folded into an accumulator. The
+ * ZK-patch then needs no vector of its own, and the term d1*d2*Z is added to
+ * the coefficients at the end.
+ *
+ * At most two domain-sized vectors are alive at any time (besides the
+ * variable assignment), and only one is if the accumulator lives in a
+ * scratch file.
+ */
+template<typename FieldT>
+qap_witness<FieldT> r1cs_to_qap_witness_map_low_memory(const r1cs_constraint_system<FieldT> &cs,
+                                                       const r1cs_primary_input<FieldT> &primary_input,
+                                                       const r1cs_auxiliary_input<FieldT> &auxiliary_input,
+                                                       const FieldT &d1,
+                                                       const FieldT &d2,
+                                                       const FieldT &d3,
+                                                       const std::string &scratch_dir)
+{
+    enter_block("Call to r1cs_to_qap_witness_map_low_memory");
+
+    /* sanity check */
+    assert(cs.is_satisfied(primary_input, auxiliary_input));
+
+    const std::shared_ptr<evaluation_domain<FieldT> > domain = get_evaluation_domain<FieldT>(cs.num_constraints() + cs.num_inputs() + 1);
+    const size_t m = domain->m;
+
+    r1cs_variable_assignment<FieldT> full_variable_assignment = primary_input;
+    full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+
+    const FieldT g = FieldT::multiplicative_generator;
+    const FieldT m_inverse = FieldT(m).inverse();
+    const FieldT Z_g = r1cs_to_qap_Z_on_coset(*domain, g);
+
+    /* the buffer also receives the leading coefficient of d1*d2*Z at the end */
+    std::vector<FieldT> buf;
+    buf.reserve(m+1);
+
+    const std::shared_ptr<const r1cs_frozen_constraint_system<FieldT> > frozen = cs.frozen();
+
+    /* evaluates the given polynomial on S into buf, then on T */
+    auto evaluate_on_T = [&] (r1cs_sparse_matrix<FieldT> r1cs_frozen_constraint_system<FieldT>::*matrix,
+                              linear_combination<FieldT> r1cs_constraint<FieldT>::*lc,
+                              const bool add_inputs)
+    {
+        buf.assign(m, FieldT::zero());
+        /* account for the additional constraints input_i * 0 = 0 */
+        if (add_inputs)
+        {
+            for (size_t i = 0; i <= cs.num_inputs(); ++i)
+            {
+                buf[i+cs.num_constraints()] = (i > 0 ? full_variable_assignment[i-1] : FieldT::one());
+            }
+        }
+        /* account for all other constraints */
+        _r1cs_to_qap_add_evaluations(cs, frozen ? &(*frozen.*matrix) : nullptr, lc, full_variable_assignment, buf);
+
+        domain->unscaled_iFFT({ &buf });
+        domain->cosetFFT({ &buf }, g, m_inverse);
+    };
+
+    enter_block("Allocate accumulator");
+    std::unique_ptr<scratch_file> scratch;
+    std::vector<FieldT> acc_vector;
+    FieldT *acc;
+    if (scratch_dir.empty())
+    {
+        acc_vector.resize(m);
+        acc = &acc_vector[0];
+    }
+    else
+    {
+        scratch.reset(new scratch_file(scratch_dir, m * sizeof(FieldT)));
+        acc = (FieldT*) scratch->data();
+        /* the mapping is raw memory; construct the elements before use */
+        std::uninitialized_fill(acc, acc + m, FieldT::zero());
+    }
+    leave_block("Allocate accumulator");
 
+    enter_block("Compute evaluation of polynomial A on set T");
+    evaluate_on_T(&r1cs_frozen_constraint_system<FieldT>::A, &r1cs_constraint<FieldT>::a, true);
+    std::copy(buf.begin(), buf.end(), acc);
+    leave_block("Compute evaluation of polynomial A on set T");
+
+    enter_block("Compute evaluation of polynomial B on set T");
+    evaluate_on_T(&r1cs_frozen_constraint_system<FieldT>::B, &r1cs_constraint<FieldT>::b, false);
+    const FieldT Z_g_d1 = Z_g * d1, Z_g_d2 = Z_g * d2;
+    /* the element-wise products are taken by batch_mul, a block at a time;
+       buf is overwritten right after */
+    const size_t block = 256;
 #ifdef MULTICORE
 #pragma omp parallel for
 #endif
-    for (size_t i = 0; i < domain->m; ++i)
+    for (size_t i0 = 0; i0 < m; i0 += block)
     {
-        H_tmp[i] = (H_tmp[i]-aC[i]);
+        const size_t len = std::min(block, m - i0);
+        FieldT tmp[block];
+        for (size_t i = 0; i < len; ++i)
+        {
+            tmp[i] = buf[i0+i] + Z_g_d2;
+        }
+        batch_mul(tmp, acc + i0, tmp, 1, len);
+        batch_mul(&buf[i0], &buf[i0], &Z_g_d1, 0, len);
+        for (size_t i = 0; i < len; ++i)
+        {
+            acc[i0+i] = tmp[i] + buf[i0+i];
+        }
     }
+    leave_block("Compute evaluation of polynomial B on set T");
 
-    enter_block("Divide by Z on set T");
-    domain->divide_by_Z_on_coset(H_tmp);
-    leave_block("Divide by Z on set T");
-
-    leave_block("Compute evaluation of polynomial H on set T");
+    enter_block("Compute evaluation of polynomial C on set T");
+    evaluate_on_T(&r1cs_frozen_constraint_system<FieldT>::C, &r1cs_constraint<FieldT>::c, false);
+    const FieldT Z_g_d3 = Z_g * d3;
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < m; ++i)
+    {
+        buf[i] = acc[i] - (buf[i] + Z_g_d3);
+    }
+    scratch.reset();
+    std::vector<FieldT>().swap(acc_vector);
+    leave_block("Compute evaluation of polynomial C on set T");
 
     enter_block("Compute coefficients of polynomial H");
-    domain->icosetFFT(H_tmp, FieldT::multiplicative_generator);
-    leave_block("Compute coefficients of polynomial H");
+    domain->unscaled_iFFT({ &buf });
 
-    enter_block("Compute sum of H and ZK-patch");
+    /* coefficient i is buf[i] * g^{-i} / (m * Z(g)) */
+    const FieldT g_inverse = g.inverse();
+    const FieldT H_scale = m_inverse * Z_g.inverse();
+#ifdef MULTICORE
+    const size_t num_chunks = omp_get_max_threads();
+#else
+    const size_t num_chunks = 1;
+#endif
+    const size_t chunk_size = (m + num_chunks - 1) / num_chunks;
 #ifdef MULTICORE
 #pragma omp parallel for
 #endif
-    for (size_t i = 0; i < domain->m; ++i)
+    for (size_t c = 0; c < num_chunks; ++c)
     {
-        coefficients_for_H[i] += H_tmp[i];
+        const size_t begin = std::min(c * chunk_size, m), end = std::min(begin + chunk_size, m);
+        batch_mul_by_powers(&buf[begin], end - begin, H_scale * (g_inverse^begin), g_inverse);
     }
-    leave_block("Compute sum of H and ZK-patch");
 
-    leave_block("Call to r1cs_to_qap_witness_map");
+    buf.resize(m+1, FieldT::zero());
+    domain->add_poly_Z(d1*d2, buf);
+    leave_block("Compute coefficients of polynomial H");
+
+    /* the cached FFT tables can be as large as a domain-sized vector */
+    basic_radix2_fft_tables<FieldT>::clear_cache();
+
+    leave_block("Call to r1cs_to_qap_witness_map_low_memory");
 
     return qap_witness<FieldT>(cs.num_variables(),
-                               domain->m,
+                               m,
                                cs.num_inputs(),
                                d1,
                                d2,
                                d3,
                                full_variable_assignment,
-                               std::move(coefficients_for_H));
+                               std::move(buf));
 }
 
 } // libsnark
@@ -3,8 +3,9 @@
 
  Declaration of interfaces for:
  - a R1CS constraint,
- - a R1CS variable assignment, and
- - a R1CS constraint system.
+ - a R1CS variable assignment,
+ - a R1CS constraint system, and
+ - a frozen R1CS constraint system, stored in compressed sparse row form.
 
  Above, R1CS stands for "Rank-1 Constraint System".
 
@@ -17,9 +18,11 @@
 #ifndef R1CS_HPP_
 #define R1CS_HPP_
 
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -91,6 +94,9 @@ using r1cs_variable_assignment = std::vector<FieldT>; /* note the changed name!
 template<typename FieldT>
 class r1cs_constraint_system;
 
+template<typename FieldT>
+class r1cs_frozen_constraint_system;
+
 template<typename FieldT>
 std::ostream& operator<<(std::ostream &out, const r1cs_constraint_system<FieldT> &cs);
 
@@ -137,12 +143,79 @@ public:
 
     void swap_AB_if_beneficial();
 
+    /**
+     * Store a frozen copy of the constraints, which is used from then on by
+     * is_satisfied and by the R1CS-to-QAP witness map. Call it once the
+     * system is final: add_constraint, swap_AB_if_beneficial and reading the
+     * system discard the copy, but direct changes to constraints do not.
+     */
+    void freeze();
+    std::shared_ptr<const r1cs_frozen_constraint_system<FieldT> > frozen() const { return frozen_cs; }
+
     bool operator==(const r1cs_constraint_system<FieldT> &other) const;
 
     friend std::ostream& operator<< <FieldT>(std::ostream &out, const r1cs_constraint_system<FieldT> &cs);
     friend std::istream& operator>> <FieldT>(std::istream &in, r1cs_constraint_system<FieldT> &cs);
 
     void report_linear_constraint_statistics() const;
+
+private:
+    std::shared_ptr<const r1cs_frozen_constraint_system<FieldT> > frozen_cs;
+};
+
+/************************* Frozen R1CS constraint system *********************/
+
+/**
+ * One of the matrices A, B, C of a R1CS constraint system, in compressed
+ * sparse row form: the terms of row i are those in [row_start[i], row_start[i+1]),
+ * with the variable indices in index and the coefficients encoded in coeff.
+ *
+ * Coefficients 1 and -1, which make up most of the coefficients of typical
+ * circuits, are encoded as coeff_one and coeff_minus_one and cost no
+ * multiplication; any other coefficient is encoded as its position in coeffs.
+ */
+template<typename FieldT>
+class r1cs_sparse_matrix {
+public:
+    static const uint32_t coeff_one = UINT32_MAX;
+    static const uint32_t coeff_minus_one = UINT32_MAX - 1;
+
+    std::vector<size_t> row_start;
+    std::vector<var_index_t> index;
+    std::vector<uint32_t> coeff;
+    std::vector<FieldT> coeffs;
+
+    r1cs_sparse_matrix() {};
+    r1cs_sparse_matrix(const std::vector<r1cs_constraint<FieldT> > &constraints,
+                       linear_combination<FieldT> r1cs_constraint<FieldT>::*lc);
+
+    size_t num_rows() const { return row_start.size() - 1; }
+    size_t num_terms() const { return index.size(); }
+
+    /* evaluates row i at (1, full_variable_assignment) */
+    FieldT evaluate_row(const size_t i, const r1cs_variable_assignment<FieldT> &full_variable_assignment) const;
+};
+
+/**
+ * A R1CS constraint system frozen into three sparse matrices, for evaluating
+ * its constraints with contiguous memory accesses and no per-constraint
+ * allocations. See r1cs_constraint_system::freeze.
+ */
+template<typename FieldT>
+class r1cs_frozen_constraint_system {
+public:
+    size_t primary_input_size;
+    size_t auxiliary_input_size;
+
+    r1cs_sparse_matrix<FieldT> A, B, C;
+
+    explicit r1cs_frozen_constraint_system(const r1cs_constraint_system<FieldT> &cs);
+
+    size_t num_inputs() const { return primary_input_size; }
+    size_t num_variables() const { return primary_input_size + auxiliary_input_size; }
+    size_t num_constraints() const { return A.num_rows(); }
+
+    bool is_satisfied(const r1cs_variable_assignment<FieldT> &full_variable_assignment) const;
 };
 
 
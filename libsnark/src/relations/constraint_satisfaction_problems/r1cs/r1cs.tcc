@@ -3,8 +3,9 @@
 
  Declaration of interfaces for:
  - a R1CS constraint,
- - a R1CS variable assignment, and
- - a R1CS constraint system.
+ - a R1CS variable assignment,
+ - a R1CS constraint system, and
+ - a frozen R1CS constraint system.
 
  See r1cs.hpp .
 
@@ -138,6 +139,20 @@ bool r1cs_constraint_system<FieldT>::is_satisfied(const r1cs_primary_input<Field
     r1cs_variable_assignment<FieldT> full_variable_assignment = primary_input;
     full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
 
+    if (frozen_cs)
+    {
+        const bool result = frozen_cs->is_satisfied(full_variable_assignment);
+#ifdef DEBUG
+        /* on failure, fall through to report the unsatisfied constraint */
+        if (result)
+        {
+            return true;
+        }
+#else
+        return result;
+#endif
+    }
+
     for (size_t c = 0; c < constraints.size(); ++c)
     {
         const FieldT ares = constraints[c].a.evaluate(full_variable_assignment);
@@ -165,6 +180,7 @@ bool r1cs_constraint_system<FieldT>::is_satisfied(const r1cs_primary_input<Field
 template<typename FieldT>
 void r1cs_constraint_system<FieldT>::add_constraint(const r1cs_constraint<FieldT> &c)
 {
+    frozen_cs.reset();
     constraints.emplace_back(c);
 }
 
@@ -174,6 +190,7 @@ void r1cs_constraint_system<FieldT>::add_constraint(const r1cs_constraint<FieldT
 #ifdef DEBUG
     constraint_annotations[constraints.size()] = annotation;
 #endif
+    frozen_cs.reset();
     constraints.emplace_back(c);
 }
 
@@ -215,6 +232,7 @@ void r1cs_constraint_system<FieldT>::swap_AB_if_beneficial()
     if (non_zero_B_count > non_zero_A_count)
     {
         enter_block("Perform the swap");
+        frozen_cs.reset();
         for (size_t i = 0; i < this->constraints.size(); ++i)
         {
             std::swap(this->constraints[i].a, this->constraints[i].b);
@@ -229,6 +247,14 @@ void r1cs_constraint_system<FieldT>::swap_AB_if_beneficial()
     leave_block("Call to r1cs_constraint_system::swap_AB_if_beneficial");
 }
 
+template<typename FieldT>
+void r1cs_constraint_system<FieldT>::freeze()
+{
+    enter_block("Call to r1cs_constraint_system::freeze");
+    frozen_cs = std::make_shared<const r1cs_frozen_constraint_system<FieldT> >(*this);
+    leave_block("Call to r1cs_constraint_system::freeze");
+}
+
 template<typename FieldT>
 bool r1cs_constraint_system<FieldT>::operator==(const r1cs_constraint_system<FieldT> &other) const
 {
@@ -259,6 +285,7 @@ std::istream& operator>>(std::istream &in, r1cs_constraint_system<FieldT> &cs)
     in >> cs.auxiliary_input_size;
 
     cs.constraints.clear();
+    cs.frozen_cs.reset();
 
     size_t s;
     in >> s;
@@ -306,5 +333,118 @@ void r1cs_constraint_system<FieldT>::report_linear_constraint_statistics() const
 #endif
 }
 
+template<typename FieldT>
+const uint32_t r1cs_sparse_matrix<FieldT>::coeff_one;
+
+template<typename FieldT>
+const uint32_t r1cs_sparse_matrix<FieldT>::coeff_minus_one;
+
+template<typename FieldT>
+r1cs_sparse_matrix<FieldT>::r1cs_sparse_matrix(const std::vector<r1cs_constraint<FieldT> > &constraints,
+                                               linear_combination<FieldT> r1cs_constraint<FieldT>::*lc)
+{
+    size_t num_terms = 0;
+    for (const r1cs_constraint<FieldT> &c : constraints)
+    {
+        num_terms += (c.*lc).terms.size();
+    }
+
+    row_start.reserve(constraints.size() + 1);
+    index.reserve(num_terms);
+    coeff.reserve(num_terms);
+
+    const FieldT one = FieldT::one(), minus_one = -FieldT::one();
+    row_start.emplace_back(0);
+    for (const r1cs_constraint<FieldT> &c : constraints)
+    {
+        for (const linear_term<FieldT> &lt : (c.*lc).terms)
+        {
+            index.emplace_back(lt.index);
+            if (lt.coeff == one)
+            {
+                coeff.emplace_back(coeff_one);
+            }
+            else if (lt.coeff == minus_one)
+            {
+                coeff.emplace_back(coeff_minus_one);
+            }
+            else
+            {
+                assert(coeffs.size() < coeff_minus_one);
+                coeff.emplace_back(coeffs.size());
+                coeffs.emplace_back(lt.coeff);
+            }
+        }
+        row_start.emplace_back(index.size());
+    }
+}
+
+template<typename FieldT>
+FieldT r1cs_sparse_matrix<FieldT>::evaluate_row(const size_t i, const r1cs_variable_assignment<FieldT> &full_variable_assignment) const
+{
+    FieldT acc = FieldT::zero();
+    for (size_t k = row_start[i]; k < row_start[i+1]; ++k)
+    {
+        if (index[k] == 0)
+        {
+            /* the constant 1 */
+            switch (coeff[k])
+            {
+            case coeff_one:
+                acc += FieldT::one();
+                break;
+            case coeff_minus_one:
+                acc -= FieldT::one();
+                break;
+            default:
+                acc += coeffs[coeff[k]];
+            }
+            continue;
+        }
+
+        const FieldT &x = full_variable_assignment[index[k]-1];
+        switch (coeff[k])
+        {
+        case coeff_one:
+            acc += x;
+            break;
+        case coeff_minus_one:
+            acc -= x;
+            break;
+        default:
+            acc += coeffs[coeff[k]] * x;
+        }
+    }
+    return acc;
+}
+
+template<typename FieldT>
+r1cs_frozen_constraint_system<FieldT>::r1cs_frozen_constraint_system(const r1cs_constraint_system<FieldT> &cs) :
+    primary_input_size(cs.primary_input_size),
+    auxiliary_input_size(cs.auxiliary_input_size),
+    A(cs.constraints, &r1cs_constraint<FieldT>::a),
+    B(cs.constraints, &r1cs_constraint<FieldT>::b),
+    C(cs.constraints, &r1cs_constraint<FieldT>::c)
+{
+}
+
+template<typename FieldT>
+bool r1cs_frozen_constraint_system<FieldT>::is_satisfied(const r1cs_variable_assignment<FieldT> &full_variable_assignment) const
+{
+    assert(full_variable_assignment.size() == num_variables());
+
+    bool satisfied = true;
+#ifdef MULTICORE
+#pragma omp parallel for reduction(&&:satisfied)
+#endif
+    for (size_t i = 0; i < num_constraints(); ++i)
+    {
+        satisfied = satisfied && (A.evaluate_row(i, full_variable_assignment) * B.evaluate_row(i, full_variable_assignment) ==
+                                  C.evaluate_row(i, full_variable_assignment));
+    }
+
+    return satisfied;
+}
+
 } // libsnark
 #endif // R1CS_TCC_
@@ -134,6 +134,39 @@ public:
     friend std::istream& operator>> <ppT>(std::istream &in, r1cs_ppzksnark_proving_key<ppT> &pk);
 };
 
+/**
+ * Binary layout of a proving key.
+ *
+ * Parsing the text serialization above is slow: every coordinate is read in
+ * decimal and, with point compression, every point costs a square root.
+ * The binary layout instead stores each query as a page-aligned array
+ * holding the in-memory image of its elements: points normalized to Z = 1
+ * (or Z = 0 for zero), uncompressed, with coordinates in Montgomery form.
+ * Reading a key amounts to one copy per query, straight out of a mapped file.
+ * The queries are copied into the vectors of the proving key, so every
+ * process holds its own copy; the mapping is dropped once the key is read.
+ *
+ * The layout is versioned, and the header records the limb size, the element
+ * sizes and the images of the group generators. A file written for another
+ * curve or on an incompatible machine is therefore rejected rather than
+ * misread. As with the text format, points are not checked to be on the
+ * curve, so the file must come from a trusted source.
+ */
+inline bool r1cs_ppzksnark_is_binary_proving_key(const char *data, const size_t size);
+
+template<typename ppT>
+void r1cs_ppzksnark_write_binary_proving_key(std::ostream &out, const r1cs_ppzksnark_proving_key<ppT> &pk);
+
+/**
+ * Read a proving key in the binary layout from memory. The data must be
+ * aligned to a machine word, as a mapped file is.
+ */
+template<typename ppT>
+r1cs_ppzksnark_proving_key<ppT> r1cs_ppzksnark_read_binary_proving_key(const char *data, const size_t size);
+
+template<typename ppT>
+r1cs_ppzksnark_proving_key<ppT> r1cs_ppzksnark_load_binary_proving_key(const std::string &path);
+
 
 /******************************* Verification key ****************************/
 
@@ -456,6 +489,47 @@ bool r1cs_ppzksnark_online_verifier_strong_IC(const r1cs_ppzksnark_processed_ver
                                               const r1cs_ppzksnark_primary_input<ppT> &primary_input,
                                               const r1cs_ppzksnark_proof<ppT> &proof);
 
+/**
+ * A batch verifier algorithm for the R1CS ppzkSNARK that:
+ * (1) accepts a non-processed and the corresponding processed verification key,
+ * (2) has strong input consistency, and
+ * (3) accepts if and only if every proof in the batch is accepted.
+ *
+ * The five pairing-product checks of every proof are raised to independent
+ * random 128-bit exponents (bar the very first, which needs none) and
+ * multiplied together. Pairings with a common G2
+ * argument are merged by multi-exponentiation in G1, so a batch of N proofs
+ * needs N + 6 Miller loops and a single final exponentiation. A batch
+ * containing an invalid proof is accepted with negligible probability.
+ * The result does not say which proofs are invalid; for that, verify them
+ * one by one.
+ *
+ * The G2 elements of the proofs must lie in the prime-order subgroup, which
+ * is_well_formed() does not check.
+ */
+template<typename ppT>
+bool r1cs_ppzksnark_online_batch_verifier_strong_IC(const r1cs_ppzksnark_verification_key<ppT> &vk,
+                                                    const r1cs_ppzksnark_processed_verification_key<ppT> &pvk,
+                                                    const std::vector<r1cs_ppzksnark_primary_input<ppT> > &primary_inputs,
+                                                    const std::vector<r1cs_ppzksnark_proof<ppT> > &proofs);
+
+/**
+ * A verifier algorithm for the R1CS ppzkSNARK that:
+ * (1) accepts a non-processed and the corresponding processed verification key,
+ * (2) has strong input consistency, and
+ * (3) combines the five pairing-product checks into one multi-pairing.
+ *
+ * This is the batch verifier above applied to a single proof: it needs 7
+ * Miller loops and one final exponentiation, instead of 10 Miller loops
+ * and five final exponentiations for r1cs_ppzksnark_online_verifier_strong_IC.
+ * The same requirement on the G2 elements of the proof applies.
+ */
+template<typename ppT>
+bool r1cs_ppzksnark_online_combined_verifier_strong_IC(const r1cs_ppzksnark_verification_key<ppT> &vk,
+                                                       const r1cs_ppzksnark_processed_verification_key<ppT> &pvk,
+                                                       const r1cs_ppzksnark_primary_input<ppT> &primary_input,
+                                                       const r1cs_ppzksnark_proof<ppT> &proof);
+
 /****************************** Miscellaneous ********************************/
 
 /**
@@ -16,10 +16,16 @@ See r1cs_ppzksnark.hpp .
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
 
+#include "common/mapped_file.hpp"
 #include "common/profiling.hpp"
 #include "common/utils.hpp"
 #include "algebra/scalar_multiplication/multiexp.hpp"
@@ -62,6 +68,204 @@ std::istream& operator>>(std::istream &in, r1cs_ppzksnark_proving_key<ppT> &pk)
     return in;
 }
 
+/*
+ * The binary proving key starts with a header of 64-bit words:
+ *
+ *   magic, version, limb size, sizeof(G1), sizeof(G2),
+ *   domain sizes of A_query, B_query and C_query,
+ *   (offset, count) of the sections, in the order given below,
+ *
+ * followed by the images of G1::one() and G2::one(). The sections are the
+ * indices and values of A_query, B_query and C_query, then H_query and
+ * K_query, each starting at a multiple of the alignment.
+ */
+const char r1cs_ppzksnark_binary_pk_magic[8] = { 'p', 'p', 'z', 'k', 's', 'n', 'p', 'k' };
+const uint64_t r1cs_ppzksnark_binary_pk_version = 1;
+const size_t r1cs_ppzksnark_binary_pk_alignment = 4096;
+const size_t r1cs_ppzksnark_binary_pk_num_sections = 8;
+const size_t r1cs_ppzksnark_binary_pk_header_words = 8 + 2 * r1cs_ppzksnark_binary_pk_num_sections;
+
+inline bool r1cs_ppzksnark_is_binary_proving_key(const char *data, const size_t size)
+{
+    return (size >= sizeof(r1cs_ppzksnark_binary_pk_magic) &&
+            memcmp(data, r1cs_ppzksnark_binary_pk_magic, sizeof(r1cs_ppzksnark_binary_pk_magic)) == 0);
+}
+
+template<typename ppT>
+std::vector<char> r1cs_ppzksnark_binary_pk_fingerprint()
+{
+    const G1<ppT> G1_one = G1<ppT>::one();
+    const G2<ppT> G2_one = G2<ppT>::one();
+
+    std::vector<char> result(sizeof(G1_one) + sizeof(G2_one));
+    memcpy(&result[0], &G1_one, sizeof(G1_one));
+    memcpy(&result[sizeof(G1_one)], &G2_one, sizeof(G2_one));
+    return result;
+}
+
+template<typename T>
+void r1cs_ppzksnark_write_binary_pk_section(std::ostream &out, size_t &pos, const size_t offset, const std::vector<T> &v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "binary proving key elements must be trivially copyable");
+
+    const std::vector<char> padding(offset - pos, 0);
+    out.write(padding.data(), padding.size());
+    out.write((const char*) v.data(), v.size() * sizeof(T));
+    pos = offset + v.size() * sizeof(T);
+}
+
+template<typename ppT>
+void r1cs_ppzksnark_write_binary_proving_key(std::ostream &out, const r1cs_ppzksnark_proving_key<ppT> &pk)
+{
+    enter_block("Call to r1cs_ppzksnark_write_binary_proving_key");
+
+    /* the layout holds normalized points, which the key may not have */
+    std::vector<knowledge_commitment<G1<ppT>, G1<ppT> > > A_values = pk.A_query.values;
+    std::vector<knowledge_commitment<G2<ppT>, G1<ppT> > > B_values = pk.B_query.values;
+    std::vector<knowledge_commitment<G1<ppT>, G1<ppT> > > C_values = pk.C_query.values;
+    G1_vector<ppT> H_query = pk.H_query;
+    G1_vector<ppT> K_query = pk.K_query;
+    kc_batch_to_special<G1<ppT>, G1<ppT> >(A_values);
+    kc_batch_to_special<G2<ppT>, G1<ppT> >(B_values);
+    kc_batch_to_special<G1<ppT>, G1<ppT> >(C_values);
+    batch_to_special<G1<ppT> >(H_query);
+    batch_to_special<G1<ppT> >(K_query);
+
+    const size_t counts[r1cs_ppzksnark_binary_pk_num_sections] = {
+        pk.A_query.indices.size(), A_values.size(),
+        pk.B_query.indices.size(), B_values.size(),
+        pk.C_query.indices.size(), C_values.size(),
+        H_query.size(), K_query.size() };
+    const size_t element_sizes[r1cs_ppzksnark_binary_pk_num_sections] = {
+        sizeof(size_t), sizeof(A_values[0]),
+        sizeof(size_t), sizeof(B_values[0]),
+        sizeof(size_t), sizeof(C_values[0]),
+        sizeof(H_query[0]), sizeof(K_query[0]) };
+
+    const std::vector<char> fingerprint = r1cs_ppzksnark_binary_pk_fingerprint<ppT>();
+
+    std::vector<uint64_t> header = {
+        0,
+        r1cs_ppzksnark_binary_pk_version,
+        sizeof(mp_limb_t),
+        sizeof(G1<ppT>),
+        sizeof(G2<ppT>),
+        pk.A_query.domain_size(),
+        pk.B_query.domain_size(),
+        pk.C_query.domain_size() };
+    memcpy(&header[0], r1cs_ppzksnark_binary_pk_magic, sizeof(r1cs_ppzksnark_binary_pk_magic));
+
+    size_t offsets[r1cs_ppzksnark_binary_pk_num_sections];
+    size_t end = header.size() * sizeof(uint64_t) + 2 * r1cs_ppzksnark_binary_pk_num_sections * sizeof(uint64_t) + fingerprint.size();
+    for (size_t i = 0; i < r1cs_ppzksnark_binary_pk_num_sections; ++i)
+    {
+        offsets[i] = (end + r1cs_ppzksnark_binary_pk_alignment - 1) / r1cs_ppzksnark_binary_pk_alignment * r1cs_ppzksnark_binary_pk_alignment;
+        end = offsets[i] + counts[i] * element_sizes[i];
+        header.emplace_back(offsets[i]);
+        header.emplace_back(counts[i]);
+    }
+    assert(header.size() == r1cs_ppzksnark_binary_pk_header_words);
+
+    out.write((const char*) header.data(), header.size() * sizeof(uint64_t));
+    out.write(fingerprint.data(), fingerprint.size());
+    size_t pos = header.size() * sizeof(uint64_t) + fingerprint.size();
+
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[0], pk.A_query.indices);
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[1], A_values);
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[2], pk.B_query.indices);
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[3], B_values);
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[4], pk.C_query.indices);
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[5], C_values);
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[6], H_query);
+    r1cs_ppzksnark_write_binary_pk_section(out, pos, offsets[7], K_query);
+    assert(pos == end);
+
+    leave_block("Call to r1cs_ppzksnark_write_binary_proving_key");
+}
+
+template<typename T>
+void r1cs_ppzksnark_read_binary_pk_section(const char *data, const size_t size, const uint64_t *section, std::vector<T> &v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "binary proving key elements must be trivially copyable");
+
+    const uint64_t offset = section[0];
+    const uint64_t count = section[1];
+    if (offset % r1cs_ppzksnark_binary_pk_alignment != 0 || offset > size || count > (size - offset) / sizeof(T))
+    {
+        throw std::runtime_error("binary proving key is truncated or corrupt");
+    }
+
+    const T *begin = (const T*) (data + offset);
+    v.assign(begin, begin + count);
+}
+
+template<typename ppT>
+r1cs_ppzksnark_proving_key<ppT> r1cs_ppzksnark_read_binary_proving_key(const char *data, const size_t size)
+{
+    enter_block("Call to r1cs_ppzksnark_read_binary_proving_key");
+
+    const std::vector<char> fingerprint = r1cs_ppzksnark_binary_pk_fingerprint<ppT>();
+    const size_t header_size = r1cs_ppzksnark_binary_pk_header_words * sizeof(uint64_t);
+
+    if (!r1cs_ppzksnark_is_binary_proving_key(data, size))
+    {
+        throw std::runtime_error("not a binary proving key");
+    }
+    if (((uintptr_t) data) % sizeof(mp_limb_t) != 0)
+    {
+        throw std::runtime_error("binary proving key is not aligned in memory");
+    }
+    if (size < header_size + fingerprint.size())
+    {
+        throw std::runtime_error("binary proving key is truncated or corrupt");
+    }
+
+    uint64_t header[r1cs_ppzksnark_binary_pk_header_words];
+    memcpy(header, data, header_size);
+    if (header[1] != r1cs_ppzksnark_binary_pk_version)
+    {
+        throw std::runtime_error("unsupported binary proving key version");
+    }
+    if (header[2] != sizeof(mp_limb_t) ||
+        header[3] != sizeof(G1<ppT>) ||
+        header[4] != sizeof(G2<ppT>) ||
+        memcmp(data + header_size, fingerprint.data(), fingerprint.size()) != 0)
+    {
+        throw std::runtime_error("binary proving key was written for another curve or machine");
+    }
+
+    r1cs_ppzksnark_proving_key<ppT> pk;
+    pk.A_query.domain_size_ = header[5];
+    pk.B_query.domain_size_ = header[6];
+    pk.C_query.domain_size_ = header[7];
+
+    const uint64_t *sections = header + 8;
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 0, pk.A_query.indices);
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 2, pk.A_query.values);
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 4, pk.B_query.indices);
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 6, pk.B_query.values);
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 8, pk.C_query.indices);
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 10, pk.C_query.values);
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 12, pk.H_query);
+    r1cs_ppzksnark_read_binary_pk_section(data, size, sections + 14, pk.K_query);
+
+    if (!pk.A_query.is_valid() || !pk.B_query.is_valid() || !pk.C_query.is_valid())
+    {
+        throw std::runtime_error("binary proving key is truncated or corrupt");
+    }
+
+    leave_block("Call to r1cs_ppzksnark_read_binary_proving_key");
+
+    return pk;
+}
+
+template<typename ppT>
+r1cs_ppzksnark_proving_key<ppT> r1cs_ppzksnark_load_binary_proving_key(const std::string &path)
+{
+    const mapped_file file(path);
+    return r1cs_ppzksnark_read_binary_proving_key<ppT>(file.data(), file.size());
+}
+
 template<typename ppT>
 bool r1cs_ppzksnark_verification_key<ppT>::operator==(const r1cs_ppzksnark_verification_key<ppT> &other) const
 {
@@ -376,9 +580,7 @@ r1cs_ppzksnark_keypair<ppT> r1cs_ppzksnark_generator(
 
     enter_block("Compute the K-query", false);
     G1_vector<ppT> K_query = batch_exp(Fr<ppT>::size_in_bits(), g1_window, g1_table, Kt);
-#ifdef USE_MIXED_ADDITION
     batch_to_special<G1<ppT> >(K_query);
-#endif
     leave_block("Compute the K-query", false);
 
     leave_block("Generate knowledge commitments");
@@ -431,6 +633,14 @@ r1cs_ppzksnark_keypair<ppT> r1cs_ppzksnark_generator(
     return r1cs_ppzksnark_keypair<ppT>(std::move(pk), std::move(vk));
 }
 
+/**
+ * The queries A, B, C and K only depend on the variable assignment, while the
+ * query H depends on the coefficients of H, computed by the FFTs of the QAP
+ * witness map. So, with more than one thread, the witness map runs on its own
+ * thread, with a quarter of the OpenMP threads, while the A-, B-, C- and
+ * K-queries are answered on the others; the H-query is answered with all
+ * threads once both are done.
+ */
 template <typename ppT>
 r1cs_ppzksnark_proof<ppT> r1cs_ppzksnark_prover(const r1cs_ppzksnark_proving_key<ppT> &pk,
                                                 const r1cs_ppzksnark_primary_input<ppT> &primary_input,
@@ -447,79 +657,128 @@ r1cs_ppzksnark_proof<ppT> r1cs_ppzksnark_prover(const r1cs_ppzksnark_proving_key
         d2 = Fr<ppT>::random_element(),
         d3 = Fr<ppT>::random_element();
 
-    enter_block("Compute the polynomial H");
-    const qap_witness<Fr<ppT> > qap_wit = r1cs_to_qap_witness_map(constraint_system, primary_input, auxiliary_input, d1, d2, d3);
-    leave_block("Compute the polynomial H");
+    const size_t num_variables = constraint_system.num_variables();
+    r1cs_variable_assignment<Fr<ppT> > full_variable_assignment = primary_input;
+    full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
 
-#ifdef DEBUG
-    const Fr<ppT> t = Fr<ppT>::random_element();
-    qap_instance_evaluation<Fr<ppT> > qap_inst = r1cs_to_qap_instance_map_with_evaluation(constraint_system, t);
-    assert(qap_inst.is_satisfied(qap_wit));
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
 #endif
 
-    knowledge_commitment<G1<ppT>, G1<ppT> > g_A = pk.A_query[0] + qap_wit.d1*pk.A_query[qap_wit.num_variables()+1];
-    knowledge_commitment<G2<ppT>, G1<ppT> > g_B = pk.B_query[0] + qap_wit.d2*pk.B_query[qap_wit.num_variables()+1];
-    knowledge_commitment<G1<ppT>, G1<ppT> > g_C = pk.C_query[0] + qap_wit.d3*pk.C_query[qap_wit.num_variables()+1];
+    auto compute_H = [&] () {
+        enter_block("Compute the polynomial H");
+        qap_witness<Fr<ppT> > qap_wit = r1cs_to_qap_witness_map(constraint_system, primary_input, auxiliary_input, d1, d2, d3);
+        leave_block("Compute the polynomial H");
+        return qap_wit;
+    };
 
-    G1<ppT> g_H = G1<ppT>::zero();
-    G1<ppT> g_K = (pk.K_query[0] +
-                   qap_wit.d1*pk.K_query[qap_wit.num_variables()+1] +
-                   qap_wit.d2*pk.K_query[qap_wit.num_variables()+2] +
-                   qap_wit.d3*pk.K_query[qap_wit.num_variables()+3]);
+    size_t query_chunks = chunks;
 
-#ifdef DEBUG
-    for (size_t i = 0; i < qap_wit.num_inputs() + 1; ++i)
+#ifdef MULTICORE
+    /* restores the number of OpenMP threads of this thread on exit, also
+       when the proof is abandoned by an exception */
+    struct omp_num_threads_guard {
+        const int saved;
+        omp_num_threads_guard() : saved(omp_get_max_threads()) {}
+        ~omp_num_threads_guard() { omp_set_num_threads(saved); }
+    } num_threads_guard;
+
+    std::future<qap_witness<Fr<ppT> > > qap_wit_future;
+    if (chunks > 1)
     {
-        assert(pk.A_query[i].g == G1<ppT>::zero());
+        const size_t H_threads = std::max<size_t>(1, chunks / 4);
+        query_chunks = chunks - H_threads;
+        omp_set_num_threads(query_chunks);
+        /* the observer is per thread, so forward it for the blocks of H */
+        const block_observer observer = get_block_observer();
+        qap_wit_future = std::async(std::launch::async, [&, H_threads, observer] () {
+            omp_set_num_threads(H_threads);
+            set_block_observer(observer);
+            return compute_H();
+        });
     }
-    assert(pk.A_query.domain_size() == qap_wit.num_variables()+2);
-    assert(pk.B_query.domain_size() == qap_wit.num_variables()+2);
-    assert(pk.C_query.domain_size() == qap_wit.num_variables()+2);
-    assert(pk.H_query.size() == qap_wit.degree()+1);
-    assert(pk.K_query.size() == qap_wit.num_variables()+4);
+    else
+    {
+        std::promise<qap_witness<Fr<ppT> > > qap_wit_promise;
+        qap_wit_promise.set_value(compute_H());
+        qap_wit_future = qap_wit_promise.get_future();
+    }
+#else
+    const qap_witness<Fr<ppT> > qap_wit = compute_H();
 #endif
 
-#ifdef MULTICORE
-    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
-#else
-    const size_t chunks = 1;
+#ifdef DEBUG
+    assert(pk.A_query.domain_size() == num_variables+2);
+    assert(pk.B_query.domain_size() == num_variables+2);
+    assert(pk.C_query.domain_size() == num_variables+2);
+    assert(pk.K_query.size() == num_variables+4);
 #endif
 
+    knowledge_commitment<G1<ppT>, G1<ppT> > g_A = pk.A_query[0] + d1*pk.A_query[num_variables+1];
+    knowledge_commitment<G2<ppT>, G1<ppT> > g_B = pk.B_query[0] + d2*pk.B_query[num_variables+1];
+    knowledge_commitment<G1<ppT>, G1<ppT> > g_C = pk.C_query[0] + d3*pk.C_query[num_variables+1];
+
+    G1<ppT> g_H = G1<ppT>::zero();
+    G1<ppT> g_K = (pk.K_query[0] +
+                   d1*pk.K_query[num_variables+1] +
+                   d2*pk.K_query[num_variables+2] +
+                   d3*pk.K_query[num_variables+3]);
+
     enter_block("Compute the proof");
 
     enter_block("Compute answer to A-query", false);
     g_A = g_A + kc_multi_exp_with_mixed_addition<G1<ppT>, G1<ppT>, Fr<ppT> >(pk.A_query,
-                                                                             1, 1+qap_wit.num_variables(),
-                                                                             qap_wit.coefficients_for_ABCs.begin(), qap_wit.coefficients_for_ABCs.begin()+qap_wit.num_variables(),
-                                                                             chunks, true);
+                                                                             1, 1+num_variables,
+                                                                             full_variable_assignment.begin(), full_variable_assignment.begin()+num_variables,
+                                                                             query_chunks, multi_exp_method_BDLO12);
     leave_block("Compute answer to A-query", false);
 
     enter_block("Compute answer to B-query", false);
     g_B = g_B + kc_multi_exp_with_mixed_addition<G2<ppT>, G1<ppT>, Fr<ppT> >(pk.B_query,
-                                                                             1, 1+qap_wit.num_variables(),
-                                                                             qap_wit.coefficients_for_ABCs.begin(), qap_wit.coefficients_for_ABCs.begin()+qap_wit.num_variables(),
-                                                                             chunks, true);
+                                                                             1, 1+num_variables,
+                                                                             full_variable_assignment.begin(), full_variable_assignment.begin()+num_variables,
+                                                                             query_chunks, multi_exp_method_BDLO12);
     leave_block("Compute answer to B-query", false);
 
     enter_block("Compute answer to C-query", false);
     g_C = g_C + kc_multi_exp_with_mixed_addition<G1<ppT>, G1<ppT>, Fr<ppT> >(pk.C_query,
-                                                                             1, 1+qap_wit.num_variables(),
-                                                                             qap_wit.coefficients_for_ABCs.begin(), qap_wit.coefficients_for_ABCs.begin()+qap_wit.num_variables(),
-                                                                             chunks, true);
+                                                                             1, 1+num_variables,
+                                                                             full_variable_assignment.begin(), full_variable_assignment.begin()+num_variables,
+                                                                             query_chunks, multi_exp_method_BDLO12);
     leave_block("Compute answer to C-query", false);
 
+    enter_block("Compute answer to K-query", false);
+    g_K = g_K + multi_exp_with_mixed_addition<G1<ppT>, Fr<ppT> >(pk.K_query.begin()+1, pk.K_query.begin()+1+num_variables,
+                                                                 full_variable_assignment.begin(), full_variable_assignment.begin()+num_variables,
+                                                                 query_chunks, multi_exp_method_BDLO12);
+    leave_block("Compute answer to K-query", false);
+
+#ifdef MULTICORE
+    enter_block("Wait for the polynomial H", false);
+    const qap_witness<Fr<ppT> > qap_wit = qap_wit_future.get();
+    leave_block("Wait for the polynomial H", false);
+    omp_set_num_threads(chunks);
+#endif
+
+#ifdef DEBUG
+    const Fr<ppT> t = Fr<ppT>::random_element();
+    qap_instance_evaluation<Fr<ppT> > qap_inst = r1cs_to_qap_instance_map_with_evaluation(constraint_system, t);
+    assert(qap_inst.is_satisfied(qap_wit));
+    for (size_t i = 0; i < qap_wit.num_inputs() + 1; ++i)
+    {
+        assert(pk.A_query[i].g == G1<ppT>::zero());
+    }
+    assert(pk.H_query.size() == qap_wit.degree()+1);
+#endif
+
     enter_block("Compute answer to H-query", false);
     g_H = g_H + multi_exp<G1<ppT>, Fr<ppT> >(pk.H_query.begin(), pk.H_query.begin()+qap_wit.degree()+1,
                                              qap_wit.coefficients_for_H.begin(), qap_wit.coefficients_for_H.begin()+qap_wit.degree()+1,
-                                             chunks, true);
+                                             chunks, multi_exp_method_BDLO12);
     leave_block("Compute answer to H-query", false);
 
-    enter_block("Compute answer to K-query", false);
-    g_K = g_K + multi_exp_with_mixed_addition<G1<ppT>, Fr<ppT> >(pk.K_query.begin()+1, pk.K_query.begin()+1+qap_wit.num_variables(),
-                                                                 qap_wit.coefficients_for_ABCs.begin(), qap_wit.coefficients_for_ABCs.begin()+qap_wit.num_variables(),
-                                                                 chunks, true);
-    leave_block("Compute answer to K-query", false);
-
     leave_block("Compute the proof");
 
     leave_block("Call to r1cs_ppzksnark_prover");
@@ -656,6 +915,173 @@ bool r1cs_ppzksnark_online_verifier_strong_IC(const r1cs_ppzksnark_processed_ver
     return result;
 }
 
+/*
+ * A random exponent for combining pairing-product checks. 128 bits make
+ * an invalid check survive the combination with probability at most 2^-128.
+ */
+template<typename ppT>
+Fr<ppT> r1cs_ppzksnark_random_check_exponent()
+{
+    bigint<Fr<ppT>::num_limbs> exponent;
+    exponent.randomize();
+    for (size_t i = 128 / GMP_NUMB_BITS; i < Fr<ppT>::num_limbs; ++i)
+    {
+        exponent.data[i] = 0;
+    }
+
+    return Fr<ppT>(exponent);
+}
+
+template<typename ppT>
+bool r1cs_ppzksnark_online_batch_verifier_strong_IC(const r1cs_ppzksnark_verification_key<ppT> &vk,
+                                                    const r1cs_ppzksnark_processed_verification_key<ppT> &pvk,
+                                                    const std::vector<r1cs_ppzksnark_primary_input<ppT> > &primary_inputs,
+                                                    const std::vector<r1cs_ppzksnark_proof<ppT> > &proofs)
+{
+    assert(primary_inputs.size() == proofs.size());
+    enter_block("Call to r1cs_ppzksnark_online_batch_verifier_strong_IC");
+
+    /*
+     * For every proof, with acc the accumulated IC query and random d1..d5,
+     * the checks
+     *
+     *   e(A, alphaA) = e(A', 1)
+     *   e(alphaB, B) = e(B', 1)
+     *   e(C, alphaC) = e(C', 1)
+     *   e(A + acc, B) = e(H, rC_Z) * e(C, 1)
+     *   e(K, gamma) = e(A + acc + C, gamma_beta) * e(gamma_beta, B)
+     *
+     * are raised to d1..d5, and all of them are multiplied into one
+     * product. Each G1 argument paired with a fixed G2 element of the key
+     * is accumulated with its exponent in a multi-exponentiation below;
+     * the G1 arguments paired with B are combined per proof.
+     */
+    std::vector<G1<ppT> > alphaA_g1, one_g1, alphaC_g1, rC_Z_g1, gamma_g1, gamma_beta_g1;
+    std::vector<Fr<ppT> > alphaA_exp, one_exp, alphaC_exp, rC_Z_exp, gamma_exp, gamma_beta_exp;
+    std::vector<G1_precomp<ppT> > B_g1_precomp;
+    std::vector<G2_precomp<ppT> > B_g2_precomp;
+
+    bool result = true;
+    for (size_t i = 0; i < proofs.size() && result; ++i)
+    {
+        const r1cs_ppzksnark_proof<ppT> &proof = proofs[i];
+
+        if (pvk.encoded_IC_query.domain_size() != primary_inputs[i].size())
+        {
+            print_indent(); printf("Input length differs from expected (got %zu, expected %zu).\n", primary_inputs[i].size(), pvk.encoded_IC_query.domain_size());
+            result = false;
+            break;
+        }
+
+        if (!proof.is_well_formed())
+        {
+            result = false;
+            break;
+        }
+
+        const accumulation_vector<G1<ppT> > accumulated_IC = pvk.encoded_IC_query.template accumulate_chunk<Fr<ppT> >(primary_inputs[i].begin(), primary_inputs[i].end(), 0);
+        const G1<ppT> A_acc = proof.g_A.g + accumulated_IC.first;
+        const G1<ppT> A_acc_C = A_acc + proof.g_C.g;
+
+        /*
+         * The combined check relies on bilinearity, which the pairing
+         * evaluation of a zero point does not have; such proofs are
+         * verified on their own, so that the outcome is the same.
+         */
+        if (proof.g_A.g.is_zero() || proof.g_A.h.is_zero() || proof.g_B.g.is_zero() || proof.g_B.h.is_zero() ||
+            proof.g_C.g.is_zero() || proof.g_C.h.is_zero() || proof.g_H.is_zero() || proof.g_K.is_zero() ||
+            A_acc.is_zero() || A_acc_C.is_zero())
+        {
+            result = r1cs_ppzksnark_online_verifier_weak_IC<ppT>(pvk, primary_inputs[i], proof);
+            continue;
+        }
+
+        /* scaling every check but one suffices */
+        const Fr<ppT> d1 = (alphaA_g1.empty() ? Fr<ppT>::one() : r1cs_ppzksnark_random_check_exponent<ppT>());
+        const Fr<ppT> d2 = r1cs_ppzksnark_random_check_exponent<ppT>();
+        const Fr<ppT> d3 = r1cs_ppzksnark_random_check_exponent<ppT>();
+        const Fr<ppT> d4 = r1cs_ppzksnark_random_check_exponent<ppT>();
+        const Fr<ppT> d5 = r1cs_ppzksnark_random_check_exponent<ppT>();
+
+        alphaA_g1.emplace_back(proof.g_A.g);
+        alphaA_exp.emplace_back(d1);
+
+        one_g1.emplace_back(proof.g_A.h);
+        one_exp.emplace_back(-d1);
+        one_g1.emplace_back(proof.g_B.h);
+        one_exp.emplace_back(-d2);
+        one_g1.emplace_back(proof.g_C.h);
+        one_exp.emplace_back(-d3);
+        one_g1.emplace_back(proof.g_C.g);
+        one_exp.emplace_back(-d4);
+
+        alphaC_g1.emplace_back(proof.g_C.g);
+        alphaC_exp.emplace_back(d3);
+
+        rC_Z_g1.emplace_back(proof.g_H);
+        rC_Z_exp.emplace_back(-d4);
+
+        gamma_g1.emplace_back(proof.g_K);
+        gamma_exp.emplace_back(d5);
+
+        gamma_beta_g1.emplace_back(A_acc_C);
+        gamma_beta_exp.emplace_back(-d5);
+
+        const G1<ppT> B_g1 = d2 * vk.alphaB_g1 + d4 * A_acc - d5 * vk.gamma_beta_g1;
+        if (!B_g1.is_zero())
+        {
+            B_g1_precomp.emplace_back(ppT::precompute_G1(B_g1));
+            B_g2_precomp.emplace_back(ppT::precompute_G2(proof.g_B.g));
+        }
+    }
+
+    if (result)
+    {
+        std::vector<G1_precomp<ppT> > P;
+        std::vector<const G2_precomp<ppT>*> Q;
+
+        const auto add_pairing = [&](const std::vector<G1<ppT> > &g1, const std::vector<Fr<ppT> > &exp, const G2_precomp<ppT> &g2_precomp) {
+            const G1<ppT> sum = multi_exp<G1<ppT>, Fr<ppT> >(g1.begin(), g1.end(), exp.begin(), exp.end(), 1, multi_exp_method_BDLO12);
+            /* e(0, Q) = 1 */
+            if (!sum.is_zero())
+            {
+                P.emplace_back(ppT::precompute_G1(sum));
+                Q.emplace_back(&g2_precomp);
+            }
+        };
+
+        add_pairing(alphaA_g1, alphaA_exp, pvk.vk_alphaA_g2_precomp);
+        add_pairing(one_g1, one_exp, pvk.pp_G2_one_precomp);
+        add_pairing(alphaC_g1, alphaC_exp, pvk.vk_alphaC_g2_precomp);
+        add_pairing(rC_Z_g1, rC_Z_exp, pvk.vk_rC_Z_g2_precomp);
+        add_pairing(gamma_g1, gamma_exp, pvk.vk_gamma_g2_precomp);
+        add_pairing(gamma_beta_g1, gamma_beta_exp, pvk.vk_gamma_beta_g2_precomp);
+        for (size_t i = 0; i < B_g1_precomp.size(); ++i)
+        {
+            P.emplace_back(B_g1_precomp[i]);
+            Q.emplace_back(&B_g2_precomp[i]);
+        }
+
+        const Fqk<ppT> product = ppT::multi_miller_loop(P, Q);
+        result = (ppT::final_exponentiation(product) == GT<ppT>::one());
+    }
+
+    leave_block("Call to r1cs_ppzksnark_online_batch_verifier_strong_IC");
+    return result;
+}
+
+template<typename ppT>
+bool r1cs_ppzksnark_online_combined_verifier_strong_IC(const r1cs_ppzksnark_verification_key<ppT> &vk,
+                                                       const r1cs_ppzksnark_processed_verification_key<ppT> &pvk,
+                                                       const r1cs_ppzksnark_primary_input<ppT> &primary_input,
+                                                       const r1cs_ppzksnark_proof<ppT> &proof)
+{
+    const std::vector<r1cs_ppzksnark_primary_input<ppT> > primary_inputs = { primary_input };
+    const std::vector<r1cs_ppzksnark_proof<ppT> > proofs = { proof };
+
+    return r1cs_ppzksnark_online_batch_verifier_strong_IC<ppT>(vk, pvk, primary_inputs, proofs);
+}
+
 template<typename ppT>
 bool r1cs_ppzksnark_verifier_strong_IC(const r1cs_ppzksnark_verification_key<ppT> &vk,
                                        const r1cs_ppzksnark_primary_input<ppT> &primary_input,
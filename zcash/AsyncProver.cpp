@@ -0,0 +1,161 @@
+#include "AsyncProver.hpp"
+
+#include <algorithm>
+
+#include "common/profiling.hpp"
+
+using namespace libsnark;
+
+namespace libzcash {
+
+AsyncJoinSplitProver::Job::Job(const Request& request, int priority,
+                               uint64_t sequence, ProgressCallback progress) :
+    request_(request), priority(priority), sequence(sequence),
+    progress(progress), cancelled(false), proof(promise.get_future()) { }
+
+AsyncJoinSplitProver::AsyncJoinSplitProver(ZCJoinSplit& params,
+                                           size_t nThreads,
+                                           size_t maxQueued) :
+    params(params), maxQueued(std::max<size_t>(1, maxQueued)),
+    nextSequence(0), stopping(false)
+{
+    params.loadProvingKey();
+
+    for (size_t i = 0; i < std::max<size_t>(1, nThreads); i++) {
+        workers.emplace_back(&AsyncJoinSplitProver::Loop, this);
+    }
+}
+
+AsyncJoinSplitProver::~AsyncJoinSplitProver()
+{
+    std::set<std::shared_ptr<Job>, JobOrder> dropped;
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        stopping = true;
+        dropped.swap(queue);
+    }
+    jobAvailable.notify_all();
+    spaceAvailable.notify_all();
+
+    for (const auto& job : dropped) {
+        job->promise.set_exception(std::make_exception_ptr(ProofCancelled()));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void AsyncJoinSplitProver::Loop()
+{
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            jobAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            job = *queue.begin();
+            queue.erase(queue.begin());
+        }
+        spaceAvailable.notify_one();
+        Run(*job);
+    }
+}
+
+void AsyncJoinSplitProver::Run(Job& job)
+{
+    // The prover enters its phases on this thread, and forwards the
+    // observer to the thread computing H in multicore builds, so the
+    // observer sees every phase and may abandon the proof between two. It
+    // may then be called from both threads at once.
+    set_block_observer([&job](const std::string& phase) {
+        if (job.cancelled) {
+            throw ProofCancelled();
+        }
+        if (job.progress) {
+            job.progress(phase);
+        }
+    });
+
+    const size_t depth = get_block_depth();
+    ZCProof proof;
+    std::exception_ptr error;
+    try {
+        if (job.cancelled) {
+            throw ProofCancelled();
+        }
+
+        Request& r = job.request_;
+        proof = params.prove(r.inputs, r.outputs, r.out_notes,
+                             r.out_ciphertexts, r.out_ephemeralKey,
+                             r.pubKeyHash, r.out_randomSeed,
+                             r.out_macs, r.out_nullifiers,
+                             r.out_commitments, r.vpub_old,
+                             r.vpub_new, r.rt);
+    } catch (...) {
+        error = std::current_exception();
+        // Drop the profiling blocks the abandoned proof left open here.
+        unwind_blocks(depth);
+    }
+
+    set_block_observer(nullptr);
+
+    // Settled under cs, where cancel checks it, so that a job cancel
+    // returned true for always fails with ProofCancelled.
+    std::lock_guard<std::mutex> lock(cs);
+    if (job.cancelled) {
+        job.promise.set_exception(std::make_exception_ptr(ProofCancelled()));
+    } else if (error) {
+        job.promise.set_exception(error);
+    } else {
+        job.promise.set_value(proof);
+    }
+}
+
+std::shared_ptr<AsyncJoinSplitProver::Job> AsyncJoinSplitProver::submit(
+    const Request& request, int priority, ProgressCallback progress)
+{
+    std::shared_ptr<Job> job;
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        spaceAvailable.wait(lock, [this] {
+            return stopping || queue.size() < maxQueued;
+        });
+        if (stopping) {
+            throw std::runtime_error("JoinSplit prover is stopping");
+        }
+        job = std::make_shared<Job>(request, priority, nextSequence++,
+                                    std::move(progress));
+        queue.insert(job);
+    }
+    jobAvailable.notify_one();
+    return job;
+}
+
+bool AsyncJoinSplitProver::cancel(const std::shared_ptr<Job>& job)
+{
+    bool dropped;
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        if (job->proof.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            return false;
+        }
+        job->cancelled = true;
+        dropped = queue.erase(job) > 0;
+    }
+
+    if (dropped) {
+        spaceAvailable.notify_one();
+        job->promise.set_exception(std::make_exception_ptr(ProofCancelled()));
+    }
+    return true;
+}
+
+size_t AsyncJoinSplitProver::queued()
+{
+    std::lock_guard<std::mutex> lock(cs);
+    return queue.size();
+}
+
+}
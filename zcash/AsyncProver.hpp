@@ -0,0 +1,114 @@
+#ifndef _ZCASYNCPROVER_H_
+#define _ZCASYNCPROVER_H_
+
+#include "JoinSplit.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace libzcash {
+
+// Delivered through the future of a proof that was cancelled.
+class ProofCancelled : public std::runtime_error {
+public:
+    ProofCancelled() : std::runtime_error("JoinSplit proof cancelled") { }
+};
+
+// Proves JoinSplits in the background on a fixed set of worker threads, all
+// sharing the proving key of one ZCJoinSplit, which is loaded only once.
+class AsyncJoinSplitProver {
+public:
+    typedef JSProofRequest<ZC_NUM_JS_INPUTS, ZC_NUM_JS_OUTPUTS> Request;
+
+    // Told the name of each phase of the proof as the prover enters it.
+    typedef std::function<void(const std::string& phase)> ProgressCallback;
+
+    class Job {
+    private:
+        friend class AsyncJoinSplitProver;
+
+        Request request_;
+        int priority;
+        uint64_t sequence;
+        ProgressCallback progress;
+        std::promise<ZCProof> promise;
+        std::atomic<bool> cancelled;
+
+    public:
+        Job(const Request& request, int priority, uint64_t sequence,
+            ProgressCallback progress);
+
+        // Ready once the proof is done, or failed or was cancelled.
+        std::shared_future<ZCProof> proof;
+
+        // The outputs of the request are filled in once the proof is ready.
+        const Request& request() const { return request_; }
+    };
+
+private:
+    struct JobOrder {
+        // Higher priorities first, then in order of submission.
+        bool operator()(const std::shared_ptr<Job>& a,
+                        const std::shared_ptr<Job>& b) const {
+            if (a->priority != b->priority) {
+                return a->priority > b->priority;
+            }
+            return a->sequence < b->sequence;
+        }
+    };
+
+    ZCJoinSplit& params;
+    size_t maxQueued;
+
+    std::mutex cs;
+    std::condition_variable jobAvailable;
+    std::condition_variable spaceAvailable;
+    std::set<std::shared_ptr<Job>, JobOrder> queue;
+    std::vector<std::thread> workers;
+    uint64_t nextSequence;
+    bool stopping;
+
+    void Loop();
+    void Run(Job& job);
+
+public:
+    // Loads the proving key of params and starts nThreads workers. At most
+    // maxQueued jobs wait for a worker at any time.
+    AsyncJoinSplitProver(ZCJoinSplit& params, size_t nThreads = 1,
+                         size_t maxQueued = 64);
+
+    // Cancels the queued jobs and waits for the running ones to finish.
+    ~AsyncJoinSplitProver();
+
+    AsyncJoinSplitProver(const AsyncJoinSplitProver&) = delete;
+    AsyncJoinSplitProver& operator=(const AsyncJoinSplitProver&) = delete;
+
+    // Queues a proof of request, blocking while the queue is full. Jobs with
+    // a higher priority are started first. progress, if set, is called at
+    // each phase of the proof, on the worker thread or on the thread the
+    // prover computes H on, possibly concurrently.
+    std::shared_ptr<Job> submit(const Request& request, int priority = 0,
+                                ProgressCallback progress = nullptr);
+
+    // Cancels job: a queued job is dropped right away, a running one is
+    // stopped at its next phase. Its future then throws ProofCancelled.
+    // Returns false if the job had already finished; otherwise its future
+    // throws ProofCancelled even if the proof completes in the meantime.
+    bool cancel(const std::shared_ptr<Job>& job);
+
+    size_t queued();
+    size_t size() const { return workers.size(); }
+};
+
+}
+
+#endif // _ZCASYNCPROVER_H_
@@ -9,18 +9,19 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    if(argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " provingKeyFileName verificationKeyFileName r1csFileName" << std::endl;
+    bool binary = (argc == 5 && std::string(argv[1]) == "--binary");
+    if(argc != 4 && !binary) {
+        std::cerr << "Usage: " << argv[0] << " [--binary] provingKeyFileName verificationKeyFileName r1csFileName" << std::endl;
         return 1;
     }
 
-    std::string pkFile = argv[1];
-    std::string vkFile = argv[2];
-    std::string r1csFile = argv[3];
+    std::string pkFile = argv[argc - 3];
+    std::string vkFile = argv[argc - 2];
+    std::string r1csFile = argv[argc - 1];
 
     auto p = ZCJoinSplit::Generate();
 
-    p->saveProvingKey(pkFile);
+    p->saveProvingKey(pkFile, binary);
     p->saveVerifyingKey(vkFile);
     p->saveR1CS(r1csFile);
 
@@ -1,4 +1,5 @@
 #include "JoinSplit.hpp"
+#include "hash.h"
 #include "prf.h"
 #include "sodium.h"
 
@@ -10,13 +11,17 @@
 #include <boost/format.hpp>
 #include <boost/optional.hpp>
 #include <fstream>
+#include <sstream>
 #include "common/default_types/r1cs_ppzksnark_pp.hpp"
+#include "common/mapped_file.hpp"
+#include "reductions/r1cs_to_qap/r1cs_to_qap.hpp"
 #include "zk_proof_systems/ppzksnark/r1cs_ppzksnark/r1cs_ppzksnark.hpp"
 #include "gadgetlib1/gadgets/hashes/sha256/sha256_gadget.hpp"
 #include "gadgetlib1/gadgets/merkle_tree/merkle_tree_check_read_gadget.hpp"
 
 #include "sync.h"
 #include "amount.h"
+#include "zcashutil.h"
 
 using namespace libsnark;
 
@@ -27,6 +32,21 @@ namespace libzcash {
 CCriticalSection cs_ParamsIO;
 CCriticalSection cs_LoadKeys;
 
+// Requires cs_LoadKeys to be held. The witness map options are libsnark
+// globals that provers read without locking, so they are set only once,
+// before the first proving key is loaded and hence before any proof starts.
+static void ReadProverOptions()
+{
+    static bool fRead = false;
+    if (fRead)
+        return;
+
+    // Bound the memory used by the witness map while proving.
+    libsnark::qap_witness_map_low_memory = GetBoolArg("-lowmemprover", libsnark::qap_witness_map_low_memory);
+    libsnark::qap_witness_map_scratch_dir = GetArg("-proverscratchdir", "");
+    fRead = true;
+}
+
 template<typename T>
 void saveToFile(std::string path, T& obj) {
     LOCK(cs_ParamsIO);
@@ -63,6 +83,114 @@ void loadFromFile(std::string path, boost::optional<T>& objIn) {
     objIn = std::move(obj);
 }
 
+// Proving keys may also be saved in libsnark's binary layout, which loads
+// with a copy per query instead of parsing and decompressing every point,
+// but is specific to the machine and build that wrote it. Both layouts are
+// accepted when loading.
+template<typename ppT>
+void saveBinaryToFile(std::string path, r1cs_ppzksnark_proving_key<ppT>& pk) {
+    LOCK(cs_ParamsIO);
+
+    std::ofstream fh;
+    fh.open(path, std::ios::binary);
+    r1cs_ppzksnark_write_binary_proving_key(fh, pk);
+    fh.flush();
+    fh.close();
+}
+
+template<typename ppT>
+void loadFromFile(std::string path, boost::optional<r1cs_ppzksnark_proving_key<ppT>>& pkIn) {
+    LOCK(cs_ParamsIO);
+
+    std::unique_ptr<mapped_file> fh;
+    try {
+        fh.reset(new mapped_file(path));
+    } catch (const std::runtime_error&) {
+        throw std::runtime_error((boost::format("could not load param file at %s") % path).str());
+    }
+
+    if (r1cs_ppzksnark_is_binary_proving_key(fh->data(), fh->size())) {
+        pkIn = r1cs_ppzksnark_read_binary_proving_key<ppT>(fh->data(), fh->size());
+        return;
+    }
+
+    std::stringstream ss;
+    ss.write(fh->data(), fh->size());
+    fh.reset();
+
+    ss.rdbuf()->pubseekpos(0, std::ios_base::in);
+
+    r1cs_ppzksnark_proving_key<ppT> obj;
+    ss >> obj;
+
+    pkIn = std::move(obj);
+}
+
+// The JoinSplit circuit, with its constraint system generated (and A and B
+// swapped if it's beneficial) once rather than for every proof. Only the
+// witness differs between proofs, so proving just reuses the protoboard
+// and the gadget layout to generate a new witness.
+template<typename FieldT, size_t NumInputs, size_t NumOutputs>
+class CompiledJoinSplitCircuit {
+public:
+    CompiledJoinSplitCircuit() : joinsplit(pb) {
+        joinsplit.generate_r1cs_constraints();
+
+        // Swap A and B if it's beneficial (less arithmetic in G2)
+        // In our circuit, we already know that it's beneficial
+        // to swap, but the estimate is cheap to perform.
+        pb.constraint_system.swap_AB_if_beneficial();
+
+        // The constraint system is final, so store it in the compact form
+        // used to evaluate it when proving.
+        pb.constraint_system.freeze();
+    }
+
+    void generate_witness(
+        const uint252& phi,
+        const uint256& rt,
+        const uint256& h_sig,
+        const boost::array<JSInput, NumInputs>& inputs,
+        const boost::array<Note, NumOutputs>& out_notes,
+        uint64_t vpub_old,
+        uint64_t vpub_new,
+        std::vector<FieldT>& primary_input,
+        std::vector<FieldT>& aux_input
+    ) {
+        // The protoboard is shared by all proofs, so witness generation
+        // is serialized; the proofs themselves can still run in parallel.
+        LOCK(cs_Witness);
+
+        pb.clear_values();
+        joinsplit.generate_r1cs_witness(
+            phi,
+            rt,
+            h_sig,
+            inputs,
+            out_notes,
+            vpub_old,
+            vpub_new
+        );
+
+        // The constraint system must be satisfied or there is an unimplemented
+        // or incorrect sanity check above. Or the constraint system is broken!
+        assert(pb.is_satisfied());
+
+        primary_input = pb.primary_input();
+        aux_input = pb.auxiliary_input();
+    }
+
+    // Never modified after construction, so it can be read without locking.
+    const r1cs_constraint_system<FieldT>& constraint_system() const {
+        return pb.constraint_system;
+    }
+
+private:
+    CCriticalSection cs_Witness;
+    protoboard<FieldT> pb;
+    joinsplit_gadget<FieldT, NumInputs, NumOutputs> joinsplit;
+};
+
 template<size_t NumInputs, size_t NumOutputs>
 class JoinSplitCircuit : public JoinSplit<NumInputs, NumOutputs> {
 public:
@@ -72,7 +200,10 @@ public:
     boost::optional<r1cs_ppzksnark_proving_key<ppzksnark_ppT>> pk;
     boost::optional<r1cs_ppzksnark_verification_key<ppzksnark_ppT>> vk;
     boost::optional<r1cs_ppzksnark_processed_verification_key<ppzksnark_ppT>> vk_precomp;
+    // Identifies the verifying key in the digests of verified proofs.
+    uint256 vk_digest;
     boost::optional<std::string> pkPath;
+    std::unique_ptr<CompiledJoinSplitCircuit<FieldT, NumInputs, NumOutputs>> circuit;
 
     JoinSplitCircuit() {}
     ~JoinSplitCircuit() {}
@@ -84,17 +215,32 @@ public:
     void loadProvingKey() {
         LOCK(cs_LoadKeys);
 
+        ReadProverOptions();
+
         if (!pk) {
             if (!pkPath) {
                 throw std::runtime_error("proving key path unknown");
             }
             loadFromFile(*pkPath, pk);
         }
+
+        compileCircuit();
+    }
+
+    // Requires cs_LoadKeys to be held.
+    void compileCircuit() {
+        if (!circuit) {
+            circuit.reset(new CompiledJoinSplitCircuit<FieldT, NumInputs, NumOutputs>());
+        }
     }
 
-    void saveProvingKey(std::string path) {
+    void saveProvingKey(std::string path, bool binary) {
         if (pk) {
-            saveToFile(path, *pk);
+            if (binary) {
+                saveBinaryToFile(path, *pk);
+            } else {
+                saveToFile(path, *pk);
+            }
         } else {
             throw std::runtime_error("cannot save proving key; key doesn't exist");
         }
@@ -108,6 +254,11 @@ public:
     }
     void processVerifyingKey() {
         vk_precomp = r1cs_ppzksnark_verifier_process_vk(*vk);
+
+        std::stringstream ss;
+        ss << *vk;
+        const std::string serialized_vk = ss.str();
+        vk_digest = Hash(serialized_vk.begin(), serialized_vk.end());
     }
     void saveVerifyingKey(std::string path) {
         if (vk) {
@@ -140,6 +291,7 @@ public:
         pk = keypair.pk;
         vk = keypair.vk;
         processVerifyingKey();
+        compileCircuit();
     }
 
     bool verify(
@@ -159,10 +311,20 @@ public:
         }
 
         try {
-            auto r1cs_proof = proof.to_libsnark_proof<r1cs_ppzksnark_proof<ppzksnark_ppT>>();
-
             uint256 h_sig = this->h_sig(randomSeed, nullifiers, pubKeyHash);
 
+            // The primary input is a function of these values, so they
+            // identify it in the cache of verified proofs.
+            CHashWriter ss(SER_GETHASH, 0);
+            ss << vk_digest << proof << rt << h_sig << macs << nullifiers
+               << commitments << vpub_old << vpub_new;
+            const uint256 digest = ss.GetHash();
+            if (verifier.isCached(digest)) {
+                return true;
+            }
+
+            auto r1cs_proof = proof.to_libsnark_proof<r1cs_ppzksnark_proof<ppzksnark_ppT>>();
+
             auto witness = joinsplit_gadget<FieldT, NumInputs, NumOutputs>::witness_map(
                 rt,
                 h_sig,
@@ -177,7 +339,8 @@ public:
                 *vk,
                 *vk_precomp,
                 witness,
-                r1cs_proof
+                r1cs_proof,
+                digest
             );
         } catch (...) {
             return false;
@@ -204,6 +367,47 @@ public:
             throw std::runtime_error("JoinSplit proving key not loaded");
         }
 
+        std::vector<FieldT> primary_input;
+        std::vector<FieldT> aux_input;
+        prepare(inputs, outputs, out_notes, out_ciphertexts, out_ephemeralKey,
+                pubKeyHash, out_randomSeed, out_macs, out_nullifiers,
+                out_commitments, vpub_old, vpub_new, rt, computeProof,
+                primary_input, aux_input);
+
+        if (!computeProof) {
+            return ZCProof();
+        }
+
+        return ZCProof(r1cs_ppzksnark_prover<ppzksnark_ppT>(
+            *pk,
+            primary_input,
+            aux_input,
+            circuit->constraint_system()
+        ));
+    }
+
+private:
+    // Everything prove does except computing the proof: checks the
+    // JoinSplit, computes its outputs and, if computeWitness is set, the
+    // primary and auxiliary inputs of the circuit.
+    void prepare(
+        const boost::array<JSInput, NumInputs>& inputs,
+        const boost::array<JSOutput, NumOutputs>& outputs,
+        boost::array<Note, NumOutputs>& out_notes,
+        boost::array<ZCNoteEncryption::Ciphertext, NumOutputs>& out_ciphertexts,
+        uint256& out_ephemeralKey,
+        const uint256& pubKeyHash,
+        uint256& out_randomSeed,
+        boost::array<uint256, NumInputs>& out_macs,
+        boost::array<uint256, NumInputs>& out_nullifiers,
+        boost::array<uint256, NumOutputs>& out_commitments,
+        uint64_t vpub_old,
+        uint64_t vpub_new,
+        const uint256& rt,
+        bool computeWitness,
+        std::vector<FieldT>& primary_input,
+        std::vector<FieldT>& aux_input
+    ) {
         if (vpub_old > MAX_MONEY) {
             throw std::invalid_argument("nonsensical vpub_old value");
         }
@@ -312,45 +516,26 @@ public:
             out_macs[i] = PRF_pk(inputs[i].key, i, h_sig);
         }
 
-        if (!computeProof) {
-            return ZCProof();
+        if (!computeWitness) {
+            return;
         }
 
-        protoboard<FieldT> pb;
         {
-            joinsplit_gadget<FieldT, NumInputs, NumOutputs> g(pb);
-            g.generate_r1cs_constraints();
-            g.generate_r1cs_witness(
-                phi,
-                rt,
-                h_sig,
-                inputs,
-                out_notes,
-                vpub_old,
-                vpub_new
-            );
+            LOCK(cs_LoadKeys);
+            compileCircuit();
         }
 
-        // The constraint system must be satisfied or there is an unimplemented
-        // or incorrect sanity check above. Or the constraint system is broken!
-        assert(pb.is_satisfied());
-
-        // TODO: These are copies, which is not strictly necessary.
-        std::vector<FieldT> primary_input = pb.primary_input();
-        std::vector<FieldT> aux_input = pb.auxiliary_input();
-
-        // Swap A and B if it's beneficial (less arithmetic in G2)
-        // In our circuit, we already know that it's beneficial
-        // to swap, but it takes so little time to perform this
-        // estimate that it doesn't matter if we check every time.
-        pb.constraint_system.swap_AB_if_beneficial();
-
-        return ZCProof(r1cs_ppzksnark_prover<ppzksnark_ppT>(
-            *pk,
+        circuit->generate_witness(
+            phi,
+            rt,
+            h_sig,
+            inputs,
+            out_notes,
+            vpub_old,
+            vpub_new,
             primary_input,
-            aux_input,
-            pb.constraint_system
-        ));
+            aux_input
+        );
     }
 };
 
@@ -12,6 +12,7 @@
 #include "uint252.h"
 
 #include <boost/array.hpp>
+#include <vector>
 
 namespace libzcash {
 
@@ -43,6 +44,36 @@ public:
     Note note(const uint252& phi, const uint256& r, size_t i, const uint256& h_sig) const;
 };
 
+// The arguments and results of one call to JoinSplit::prove, named after
+// the corresponding parameters.
+template<size_t NumInputs, size_t NumOutputs>
+class JSProofRequest {
+public:
+    boost::array<JSInput, NumInputs> inputs;
+    boost::array<JSOutput, NumOutputs> outputs;
+    uint256 pubKeyHash;
+    uint64_t vpub_old;
+    uint64_t vpub_new;
+    uint256 rt;
+
+    boost::array<Note, NumOutputs> out_notes;
+    boost::array<ZCNoteEncryption::Ciphertext, NumOutputs> out_ciphertexts;
+    uint256 out_ephemeralKey;
+    uint256 out_randomSeed;
+    boost::array<uint256, NumInputs> out_macs;
+    boost::array<uint256, NumInputs> out_nullifiers;
+    boost::array<uint256, NumOutputs> out_commitments;
+
+    JSProofRequest(const boost::array<JSInput, NumInputs>& inputs,
+                   const boost::array<JSOutput, NumOutputs>& outputs,
+                   const uint256& pubKeyHash,
+                   uint64_t vpub_old,
+                   uint64_t vpub_new,
+                   const uint256& rt)
+        : inputs(inputs), outputs(outputs), pubKeyHash(pubKeyHash),
+          vpub_old(vpub_old), vpub_new(vpub_new), rt(rt) { }
+};
+
 template<size_t NumInputs, size_t NumOutputs>
 class JoinSplit {
 public:
@@ -59,7 +90,9 @@ public:
     virtual void setProvingKeyPath(std::string) = 0;
     virtual void loadProvingKey() = 0;
 
-    virtual void saveProvingKey(std::string path) = 0;
+    // The text layout is portable; the binary layout loads much faster but
+    // only on machines and builds compatible with the one that saved it.
+    virtual void saveProvingKey(std::string path, bool binary = false) = 0;
     virtual void loadVerifyingKey(std::string path) = 0;
     virtual void saveVerifyingKey(std::string path) = 0;
     virtual void saveR1CS(std::string path) = 0;
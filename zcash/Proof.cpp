@@ -1,9 +1,16 @@
 #include "Proof.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <boost/static_assert.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <mutex>
+#include <set>
 
 #include "crypto/common.h"
+#include "random.h"
+#include "zcashutil.h"
 #include "common/default_types/r1cs_ppzksnark_pp.hpp"
 #include "zk_proof_systems/ppzksnark/r1cs_ppzksnark/r1cs_ppzksnark.hpp"
 
@@ -223,6 +230,170 @@ void initialize_curve_params()
     std::call_once (init_public_params_once_flag, curve_pp::init_public_params);
 }
 
+namespace {
+
+/**
+ * Cache of the digests of successfully verified proofs, to avoid verifying
+ * a JoinSplit proof twice for every transaction (once when accepted into
+ * the memory pool, and again when accepted into the block chain)
+ */
+class ProofCache
+{
+private:
+    std::set<uint256> setValid;
+    boost::shared_mutex cs_proofcache;
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+public:
+    ProofCache() : nHits(0), nMisses(0) { }
+
+    bool Get(const uint256& digest)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+
+        if (setValid.count(digest)) {
+            nHits++;
+            return true;
+        }
+        nMisses++;
+        return false;
+    }
+
+    void Set(const uint256& digest)
+    {
+        // DoS prevention: limit cache size to a few MB
+        // (~100 bytes per cache entry times 50,000 entries)
+        int64_t nMaxCacheSize = GetArg("-maxproofcachesize", 50000);
+        if (nMaxCacheSize <= 0) return;
+
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+
+        while (static_cast<int64_t>(setValid.size()) > nMaxCacheSize)
+        {
+            // Evict a random entry, so that an attacker cannot predict
+            // which proofs will have to be verified again.
+            std::set<uint256>::iterator it = setValid.lower_bound(GetRandHash());
+            if (it == setValid.end())
+                it = setValid.begin();
+            setValid.erase(it);
+        }
+
+        setValid.insert(digest);
+    }
+
+    ProofCacheStats Stats()
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return ProofCacheStats { nHits, nMisses, setValid.size() };
+    }
+};
+
+ProofCache proofCache;
+
+}
+
+ProofCacheStats proof_cache_stats()
+{
+    return proofCache.Stats();
+}
+
+ProofVerificationPool::ProofVerificationPool(size_t nThreads) : stopping(false)
+{
+    if (nThreads == 0) {
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < nThreads; i++) {
+        workers.emplace_back(&ProofVerificationPool::Loop, this);
+    }
+}
+
+ProofVerificationPool::~ProofVerificationPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        stopping = true;
+    }
+    cond.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ProofVerificationPool::Loop()
+{
+    while (true) {
+        std::packaged_task<bool()> job;
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            cond.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+std::future<bool> ProofVerificationPool::submit(std::function<bool()> job)
+{
+    std::packaged_task<bool()> task(std::move(job));
+    std::future<bool> result = task.get_future();
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        jobs.push_back(std::move(task));
+    }
+    cond.notify_one();
+    return result;
+}
+
+struct ProofVerifier::DeferredProofs {
+    // Proofs checked against the same verification key are batched together.
+    struct Batch {
+        const r1cs_ppzksnark_verification_key<curve_pp>* vk;
+        const r1cs_ppzksnark_processed_verification_key<curve_pp>* pvk;
+        std::vector<r1cs_primary_input<curve_Fr>> primary_inputs;
+        std::vector<r1cs_ppzksnark_proof<curve_pp>> proofs;
+        std::vector<size_t> positions;
+        std::vector<uint256> digests;
+
+        Batch(const r1cs_ppzksnark_verification_key<curve_pp>* vk,
+              const r1cs_ppzksnark_processed_verification_key<curve_pp>* pvk) :
+            vk(vk), pvk(pvk) { }
+    };
+
+    std::vector<Batch> batches;
+    size_t count = 0;
+
+    // In parallel mode, the results of the proofs handed to the pool, in
+    // order of the check() calls.
+    ProofVerificationPool* pool;
+    std::vector<std::future<bool>> pending;
+
+    DeferredProofs(ProofVerificationPool* pool) : pool(pool) { }
+
+    // The pending jobs refer to the verifying keys, so they must not
+    // outlive this context.
+    ~DeferredProofs() {
+        for (auto& result : pending) {
+            result.wait();
+        }
+    }
+};
+
+ProofVerifier::ProofVerifier(bool perform_verification, bool batch,
+                             ProofVerificationPool* pool) :
+    perform_verification(perform_verification),
+    deferred(batch || pool ? new DeferredProofs(pool) : nullptr) { }
+
+ProofVerifier::~ProofVerifier() { }
+
+ProofVerifier::ProofVerifier(ProofVerifier&&) = default;
+ProofVerifier& ProofVerifier::operator=(ProofVerifier&&) = default;
+
 ProofVerifier ProofVerifier::Strict() {
     initialize_curve_params();
     return ProofVerifier(true);
@@ -233,19 +404,135 @@ ProofVerifier ProofVerifier::Disabled() {
     return ProofVerifier(false);
 }
 
+ProofVerifier ProofVerifier::Batch() {
+    initialize_curve_params();
+    return ProofVerifier(true, true);
+}
+
+ProofVerifier ProofVerifier::Parallel(ProofVerificationPool& pool) {
+    initialize_curve_params();
+    return ProofVerifier(true, false, &pool);
+}
+
 template<>
 bool ProofVerifier::check(
     const r1cs_ppzksnark_verification_key<curve_pp>& vk,
     const r1cs_ppzksnark_processed_verification_key<curve_pp>& pvk,
     const r1cs_primary_input<curve_Fr>& primary_input,
-    const r1cs_ppzksnark_proof<curve_pp>& proof
+    const r1cs_ppzksnark_proof<curve_pp>& proof,
+    const uint256& digest
 )
 {
-    if (perform_verification) {
-        return r1cs_ppzksnark_online_verifier_strong_IC<curve_pp>(pvk, primary_input, proof);
-    } else {
+    if (!perform_verification) {
+        return true;
+    }
+
+    if (deferred && deferred->pool) {
+        // The keys are shared by reference with the workers.
+        deferred->pending.push_back(deferred->pool->submit(
+            [&vk, &pvk, primary_input, proof, digest]() {
+                bool result = r1cs_ppzksnark_online_combined_verifier_strong_IC<curve_pp>(
+                    vk, pvk, primary_input, proof);
+                if (result && !digest.IsNull()) {
+                    proofCache.Set(digest);
+                }
+                return result;
+            }));
         return true;
     }
+
+    if (deferred) {
+        DeferredProofs::Batch* batch = nullptr;
+        for (auto& b : deferred->batches) {
+            if (b.vk == &vk && b.pvk == &pvk) {
+                batch = &b;
+                break;
+            }
+        }
+        if (!batch) {
+            deferred->batches.emplace_back(&vk, &pvk);
+            batch = &deferred->batches.back();
+        }
+
+        batch->primary_inputs.push_back(primary_input);
+        batch->proofs.push_back(proof);
+        batch->positions.push_back(deferred->count++);
+        batch->digests.push_back(digest);
+        return true;
+    }
+
+    // Proofs deserialized from ZCProof have their G2 element in the
+    // subgroup, so the five checks can be combined into one.
+    bool result = r1cs_ppzksnark_online_combined_verifier_strong_IC<curve_pp>(vk, pvk, primary_input, proof);
+    if (result && !digest.IsNull()) {
+        proofCache.Set(digest);
+    }
+    return result;
+}
+
+bool ProofVerifier::isCached(const uint256& digest)
+{
+    return perform_verification && proofCache.Get(digest);
+}
+
+bool ProofVerifier::verifyBatch(std::vector<size_t>* invalid)
+{
+    if (invalid) {
+        invalid->clear();
+    }
+    if (!deferred) {
+        return true;
+    }
+
+    bool result = true;
+    for (size_t i = 0; i < deferred->pending.size(); i++) {
+        bool valid = false;
+        try {
+            valid = deferred->pending[i].get();
+        } catch (...) { }
+        if (!valid) {
+            result = false;
+            if (invalid) {
+                invalid->push_back(i);
+            }
+        }
+    }
+    deferred->pending.clear();
+
+    for (const auto& batch : deferred->batches) {
+        if (r1cs_ppzksnark_online_batch_verifier_strong_IC<curve_pp>(
+                *batch.vk, *batch.pvk, batch.primary_inputs, batch.proofs)) {
+            for (const auto& digest : batch.digests) {
+                if (!digest.IsNull()) {
+                    proofCache.Set(digest);
+                }
+            }
+            continue;
+        }
+
+        result = false;
+        if (!invalid) {
+            break;
+        }
+
+        // Find the culprits by verifying the proofs one at a time.
+        for (size_t i = 0; i < batch.proofs.size(); i++) {
+            if (!r1cs_ppzksnark_online_verifier_strong_IC<curve_pp>(
+                    *batch.pvk, batch.primary_inputs[i], batch.proofs[i])) {
+                invalid->push_back(batch.positions[i]);
+            } else if (!batch.digests[i].IsNull()) {
+                proofCache.Set(batch.digests[i]);
+            }
+        }
+    }
+
+    if (invalid) {
+        std::sort(invalid->begin(), invalid->end());
+    }
+
+    deferred->batches.clear();
+    deferred->count = 0;
+    return result;
 }
 
 }
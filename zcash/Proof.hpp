@@ -4,6 +4,15 @@
 #include "serialize.h"
 #include "uint256.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace libzcash {
 
 const unsigned char G1_PREFIX_MASK = 0x02;
@@ -237,13 +246,51 @@ public:
 
 void initialize_curve_params();
 
+// A pool of worker threads verifying proofs in the background, so that the
+// JoinSplits of one or many transactions are verified concurrently. Jobs
+// refer to the caller's verifying keys, so no per-thread copies are made.
+class ProofVerificationPool {
+private:
+    std::mutex cs;
+    std::condition_variable cond;
+    std::deque<std::packaged_task<bool()>> jobs;
+    std::vector<std::thread> workers;
+    bool stopping;
+
+    void Loop();
+
+public:
+    // Starts nThreads workers, or one per core if nThreads is 0.
+    explicit ProofVerificationPool(size_t nThreads = 0);
+
+    // Runs the jobs still queued, then stops the workers.
+    ~ProofVerificationPool();
+
+    ProofVerificationPool(const ProofVerificationPool&) = delete;
+    ProofVerificationPool& operator=(const ProofVerificationPool&) = delete;
+
+    // Queues a job; its result is delivered through the returned future.
+    std::future<bool> submit(std::function<bool()> job);
+
+    size_t size() const { return workers.size(); }
+};
+
 class ProofVerifier {
 private:
+    struct DeferredProofs;
+
     bool perform_verification;
 
-    ProofVerifier(bool perform_verification) : perform_verification(perform_verification) { }
+    // Proofs passed to check() and not yet verified, in batch or parallel
+    // mode.
+    std::unique_ptr<DeferredProofs> deferred;
+
+    ProofVerifier(bool perform_verification, bool batch = false,
+                  ProofVerificationPool* pool = nullptr);
 
 public:
+    ~ProofVerifier();
+
     // ProofVerifier should never be copied
     ProofVerifier(const ProofVerifier&) = delete;
     ProofVerifier& operator=(const ProofVerifier&) = delete;
@@ -259,6 +306,35 @@ public:
     // such as during reindexing.
     static ProofVerifier Disabled();
 
+    // Creates a verification context that defers the proofs passed to
+    // check() and verifies them together in verifyBatch(), which is much
+    // cheaper than verifying them one at a time. check() then always
+    // returns true, so its result must not be acted upon until
+    // verifyBatch() has succeeded.
+    static ProofVerifier Batch();
+
+    // Creates a verification context that hands the proofs passed to
+    // check() to the pool and collects the results in verifyBatch(). As in
+    // batch mode, check() always returns true, and the verifying keys must
+    // outlive the verifyBatch() call. The pool must outlive the context.
+    static ProofVerifier Parallel(ProofVerificationPool& pool);
+
+    // Verifies the proofs deferred since the last call, returning true if
+    // all of them are valid. Otherwise, if invalid is not null, it is set
+    // to the positions (in order of the check() calls) of the invalid
+    // proofs. Contexts that are not in batch or parallel mode have nothing
+    // to verify.
+    bool verifyBatch(std::vector<size_t>* invalid = nullptr);
+
+    // Returns true if the proof identified by digest is in the cache of
+    // successfully verified proofs, in which case it need not be checked
+    // again. The digest must commit to the verifying key, the proof and
+    // the primary input.
+    bool isCached(const uint256& digest);
+
+    // Verifies a proof, or defers it in batch and parallel mode. If digest
+    // is not null, the proof is added to the cache once it is known to be
+    // valid.
     template <typename VerificationKey,
               typename ProcessedVerificationKey,
               typename PrimaryInput,
@@ -268,10 +344,22 @@ public:
         const VerificationKey& vk,
         const ProcessedVerificationKey& pvk,
         const PrimaryInput& pi,
-        const Proof& p
+        const Proof& p,
+        const uint256& digest = uint256()
     );
 };
 
+struct ProofCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t entries;
+};
+
+// Returns the counters of the cache of successfully verified proofs, which
+// saves verifying a JoinSplit proof again when its transaction is accepted
+// into the memory pool and later into the block chain.
+ProofCacheStats proof_cache_stats();
+
 }
 
 #endif // _ZCPROOF_H_